@@ -0,0 +1,83 @@
+/**
+ * Cost of entering a plugin's sub-interpreter for one FFI call, with the per-call PythonGIL the FFI used to build
+ * against the cached per-thread state InterpreterLock hands out. Each call runs a no-op backend method, from a
+ * thread other than the one that created the interpreter, like calls from the IPC server do.
+ *
+ * usage: bench_ffi_entry [calls, default 200000]
+ */
+#include <core/ffi/ffi.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+template <typename Fn>
+static void Measure(const char* name, std::size_t calls, Fn fn)
+{
+    // warm up first, the cached path only allocates on a thread's first call.
+    for (std::size_t i = 0; i < 1000; i++)
+    {
+        fn();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < calls; i++)
+    {
+        fn();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%-16s %8.3f us/call\n", name, seconds * 1e6 / calls);
+}
+
+/* the body of an FFI call, what's measured is everything around it. */
+static void CallNoop()
+{
+    PyObject* callable = PyDict_GetItemString(PyModule_GetDict(PyImport_AddModule("__main__")), "noop");
+    PyObject* result = callable ? PyObject_CallNoArgs(callable) : nullptr;
+
+    if (!result)
+    {
+        PyErr_Print();
+        std::exit(1);
+    }
+    Py_DECREF(result);
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t calls = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+
+    Py_Initialize();
+    PyThreadState* mainThreadState = PyThreadState_Get();
+    PyThreadState* pluginThreadState = Py_NewInterpreter();
+
+    PyRun_SimpleString("def noop():\n    return None\n");
+    PyEval_SaveThread();
+
+    std::thread([&]
+    {
+        Measure("PythonGIL", calls, [&]
+        {
+            auto gil = std::make_shared<PythonGIL>();
+            gil->HoldAndLockGILOnThread(pluginThreadState);
+            CallNoop();
+            gil->ReleaseAndUnLockGIL();
+        });
+
+        Measure("InterpreterLock", calls, [&]
+        {
+            InterpreterLock interpreterLock(pluginThreadState);
+            CallNoop();
+        });
+    }).join();
+
+    PyEval_RestoreThread(pluginThreadState);
+    InterpreterLock::Purge(PyThreadState_GetInterpreter(pluginThreadState));
+    Py_EndInterpreter(pluginThreadState);
+
+    PyThreadState_Swap(mainThreadState);
+    Py_Finalize();
+    return 0;
+}
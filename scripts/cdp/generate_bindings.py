@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+"""
+Generates src/core/cdp/protocol.h, typed DevTools protocol bindings, from a protocol description.
+
+The input uses the same schema as Chromium's browser_protocol.json, protocol.json here is the subset of it that
+Millennium actually talks. To bind a new command or event, copy its definition from upstream into protocol.json
+and re-run this script (or build the `cdp_bindings` target).
+
+usage: generate_bindings.py [protocol.json] [output.h]
+"""
+import json
+import os
+import sys
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+DEFAULT_INPUT = os.path.join(ROOT, "scripts", "cdp", "protocol.json")
+DEFAULT_OUTPUT = os.path.join(ROOT, "src", "core", "cdp", "protocol.h")
+
+CPP_KEYWORDS = {"auto", "bool", "break", "case", "char", "class", "const", "default", "delete", "do", "double", "else",
+                "enum", "explicit", "float", "for", "if", "int", "long", "namespace", "new", "operator", "private",
+                "public", "return", "short", "signed", "static", "struct", "switch", "this", "throw", "try", "type",
+                "typename", "union", "unsigned", "using", "virtual", "void", "while"}
+
+PRIMITIVES = {"string": "std::string_view", "integer": "long long", "number": "double", "boolean": "bool",
+              "binary": "std::string_view", "any": "RawJson", "object": "RawJson"}
+
+
+def field_name(name):
+    return name + "_" if name in CPP_KEYWORDS else name
+
+
+def struct_name(name):
+    return name[0].upper() + name[1:]
+
+
+class Generator:
+    def __init__(self, protocol):
+        self.domains = protocol["domains"]
+        self.types = {}
+
+        for domain in self.domains:
+            for type_ in domain.get("types", []):
+                self.types[domain["domain"] + "." + type_["id"]] = type_
+
+    def is_struct(self, qualified):
+        type_ = self.types.get(qualified)
+        return type_ is not None and type_["type"] == "object" and "properties" in type_
+
+    def resolve(self, domain, member):
+        """map a protocol member onto the C++ type it is written from"""
+        if "$ref" in member:
+            qualified = member["$ref"] if "." in member["$ref"] else domain + "." + member["$ref"]
+
+            if self.is_struct(qualified):
+                owner, name = qualified.split(".")
+                return name if owner == domain else owner + "::" + name
+
+            type_ = self.types.get(qualified)
+            # enums & aliases of primitives, anything we don't know about is passed through as raw json.
+            return PRIMITIVES.get(type_["type"], "RawJson") if type_ else "RawJson"
+
+        if member["type"] == "array":
+            return "std::vector<{}>".format(self.resolve(domain, member["items"]))
+
+        return PRIMITIVES.get(member["type"], "RawJson")
+
+    def methods(self):
+        methods = []
+        for domain in self.domains:
+            for kind in ("commands", "events"):
+                for entry in domain.get(kind, []):
+                    methods.append(domain["domain"] + "." + entry["name"])
+        return sorted(methods)
+
+    def emit_parser(self, out, names, indent):
+        """emit a switch tree over the characters that tell `names` apart, every name costs at most one compare"""
+        pad = " " * indent
+
+        if len(names) == 1:
+            out.append('{}return name == "{}" ? Method::{} : Method::Unknown;'.format(pad, names[0], enum_name(names[0])))
+            return
+
+        length = min(len(name) for name in names)
+        position = max(range(length), key=lambda i: len({name[i] for name in names}))
+
+        buckets = {}
+        for name in names:
+            buckets.setdefault(name[position], []).append(name)
+
+        out.append("{}switch (name[{}])".format(pad, position))
+        out.append("{}{{".format(pad))
+        for character in sorted(buckets):
+            out.append("{}    case '{}':".format(pad, character))
+            out.append("{}    {{".format(pad))
+            self.emit_parser(out, buckets[character], indent + 8)
+            out.append("{}    }}".format(pad))
+        out.append("{}}}".format(pad))
+        out.append("{}return Method::Unknown;".format(pad))
+
+    def emit_struct(self, out, domain, name, members, method=None):
+        out.append("        struct {}".format(name))
+        out.append("        {")
+
+        if method is not None:
+            out.append("            static constexpr Method method = Method::{};".format(enum_name(method)))
+            if members:
+                out.append("")
+
+        for member in members:
+            cpp_type = self.resolve(domain, member)
+
+            if member.get("optional"):
+                out.append("            std::optional<{}> {};".format(cpp_type, field_name(member["name"])))
+            elif cpp_type in ("long long", "double"):
+                out.append("            {} {} = 0;".format(cpp_type, field_name(member["name"])))
+            elif cpp_type == "bool":
+                out.append("            {} {} = false;".format(cpp_type, field_name(member["name"])))
+            else:
+                out.append("            {} {};".format(cpp_type, field_name(member["name"])))
+
+        out.append("        };")
+        out.append("")
+
+        # parameterless commands still write an empty object, `params` is always sent.
+        argument = "value" if members else ""
+
+        out.append("        inline void Write(Writer& writer, const {}& {})".format(name, argument).replace("& )", "&)"))
+        out.append("        {")
+        out.append("            writer.BeginObject();")
+        for member in members:
+            field = field_name(member["name"])
+
+            if member.get("optional"):
+                out.append('            if (value.{0}) {{ writer.Key("{1}"); Write(writer, *value.{0}); }}'.format(field, member["name"]))
+            else:
+                out.append('            writer.Key("{}"); Write(writer, value.{});'.format(member["name"], field))
+        out.append("            writer.EndObject();")
+        out.append("        }")
+        out.append("")
+
+        out.append("        inline std::size_t EstimateSize(const {}& {})".format(name, argument).replace("& )", "&)"))
+        out.append("        {")
+        if members:
+            terms = ["EstimateSize(value.{}) + {}".format(field_name(member["name"]), len(member["name"]) + 4) for member in members]
+            out.append("            return 2 + {};".format(" + ".join(terms)))
+        else:
+            out.append("            return 2;")
+        out.append("        }")
+        out.append("")
+
+    def generate(self):
+        methods = self.methods()
+        out = []
+
+        out.append("// Generated by scripts/cdp/generate_bindings.py from scripts/cdp/protocol.json, do not edit by hand.")
+        out.append("#pragma once")
+        out.append("#include <core/cdp/writer.h>")
+        out.append("")
+        out.append("namespace CDP")
+        out.append("{")
+        out.append("    enum class Method : unsigned short")
+        out.append("    {")
+        out.append("        Unknown,")
+        for method in methods:
+            out.append("        {},".format(enum_name(method)))
+        out.append("        Count")
+        out.append("    };")
+        out.append("")
+        out.append("    inline constexpr std::string_view MethodNames[] =")
+        out.append("    {")
+        out.append('        "",')
+        for method in methods:
+            out.append('        "{}",'.format(method))
+        out.append("    };")
+        out.append("")
+        out.append("    constexpr std::string_view GetMethodName(Method method)")
+        out.append("    {")
+        out.append("        return MethodNames[(std::size_t)method];")
+        out.append("    }")
+        out.append("")
+        out.append("    /// @brief resolve a method name by switching on its length and then on the characters that tell the")
+        out.append("    /// candidates apart, so a name is confirmed with a single compare and never hashed.")
+        out.append("    inline Method ParseMethod(std::string_view name)")
+        out.append("    {")
+        out.append("        switch (name.size())")
+        out.append("        {")
+
+        by_length = {}
+        for method in methods:
+            by_length.setdefault(len(method), []).append(method)
+
+        for length in sorted(by_length):
+            out.append("            case {}:".format(length))
+            out.append("            {")
+            self.emit_parser(out, by_length[length], 16)
+            out.append("            }")
+
+        out.append("        }")
+        out.append("        return Method::Unknown;")
+        out.append("    }")
+        out.append("")
+
+        for domain in self.domains:
+            name = domain["domain"]
+            commands = domain.get("commands", [])
+            types = [type_ for type_ in domain.get("types", []) if self.is_struct(name + "." + type_["id"])]
+
+            if not commands and not types:
+                continue
+
+            out.append("    namespace {}".format(name))
+            out.append("    {")
+            # the primitive overloads live in CDP, they'd otherwise be hidden by the ones declared below.
+            out.append("        using CDP::Write;")
+            out.append("        using CDP::EstimateSize;")
+            out.append("")
+            for type_ in types:
+                self.emit_struct(out, name, type_["id"], type_["properties"])
+            for command in commands:
+                self.emit_struct(out, name, struct_name(command["name"]), command.get("parameters", []), name + "." + command["name"])
+            out[-1:] = ["    }", ""]
+
+        out.append("    /// @brief serialize a command into a ready to send message, sized up front so the buffer is allocated once.")
+        out.append("    template <typename Command>")
+        out.append("    std::string Serialize(long long messageId, const Command& command, std::string_view sessionId = {})")
+        out.append("    {")
+        out.append("        Writer writer(EstimateSize(command) + GetMethodName(Command::method).size() + sessionId.size() + 64);")
+        out.append("")
+        out.append("        writer.BeginObject();")
+        out.append('        writer.Key("id"); writer.Integer(messageId);')
+        out.append('        writer.Key("method"); writer.String(GetMethodName(Command::method));')
+        out.append("")
+        out.append("        if (!sessionId.empty())")
+        out.append("        {")
+        out.append('            writer.Key("sessionId"); writer.String(sessionId);')
+        out.append("        }")
+        out.append("")
+        out.append('        writer.Key("params"); Write(writer, command);')
+        out.append("        writer.EndObject();")
+        out.append("        return writer.Take();")
+        out.append("    }")
+        out.append("}")
+        return "\n".join(out) + "\n"
+
+
+def enum_name(method):
+    return method.replace(".", "_")
+
+
+def main():
+    source = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_INPUT
+    target = sys.argv[2] if len(sys.argv) > 2 else DEFAULT_OUTPUT
+
+    with open(source, "r", encoding="utf-8") as file:
+        header = Generator(json.load(file)).generate()
+
+    with open(target, "w", encoding="utf-8", newline="\n") as file:
+        file.write(header)
+
+
+if __name__ == "__main__":
+    main()
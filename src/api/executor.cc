@@ -57,14 +57,19 @@ PyObject* CallFrontendMethod(PyObject* self, PyObject* args, PyObject* kwargs)
 {
     const char* methodName = NULL;
     PyObject* parameterList = NULL;
+    double timeoutSeconds = -1;
 
-    static const char* keywordArgsList[] = { "method_name", "params", NULL };
+    static const char* keywordArgsList[] = { "method_name", "params", "timeout", NULL };
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|O", (char**)keywordArgsList, &methodName, &parameterList)) 
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|Od", (char**)keywordArgsList, &methodName, &parameterList, &timeoutSeconds)) 
     {
         return NULL;
     }
 
+    const std::chrono::milliseconds timeout = timeoutSeconds < 0 
+        ? JavaScript::DefaultEvaluateTimeout 
+        : std::chrono::milliseconds(static_cast<long long>(timeoutSeconds * 1000));
+
     std::map<std::string, JavaScript::Types> typeMap 
     {
         { "str", JavaScript::Types::String },
@@ -121,7 +126,8 @@ PyObject* CallFrontendMethod(PyObject* self, PyObject* args, PyObject* kwargs)
             "if (typeof PLUGIN_LIST === 'undefined' || !PLUGIN_LIST?.['{}']) throw new window.MillenniumFrontEndError('frontend not loaded yet!');\n\n{}", 
             pluginName, 
             script
-        ) 
+        ),
+        timeout
     );
 }
 
@@ -149,19 +155,7 @@ PyObject* RemoveBrowserModule(PyObject* self, PyObject* args)
         return NULL;
     }
 
-    bool success = false;
-    const auto moduleList = WebkitHandler::get().m_hookListPtr;
-
-    for (auto it = moduleList->begin(); it != moduleList->end();)
-    {
-        if (it->id == moduleId) 
-        {
-            it = moduleList->erase(it);
-            success = true;
-        } 
-        else ++it;
-    }
-    return PyBool_FromLong(success);
+    return PyBool_FromLong(WebkitHandler::get().RemoveHook(moduleId));
 }
 
 unsigned long long AddBrowserModule(PyObject* args, WebkitHandler::TagTypes type) 
@@ -175,20 +169,17 @@ unsigned long long AddBrowserModule(PyObject* args, WebkitHandler::TagTypes type
         return 0;
     }
 
-    g_hookedModuleId++;
     auto path = SystemIO::GetSteamPath() / "steamui" / moduleItem;
 
     try 
     {
-        WebkitHandler::get().m_hookListPtr->push_back({ path.generic_string(), std::regex(regexSelector), type, g_hookedModuleId });
+        return WebkitHandler::get().AddHook(path.generic_string(), regexSelector, type);
     } 
     catch (const std::regex_error& e) 
     {
         LOG_ERROR("Attempted to add a browser module with invalid regex: {} ({})", regexSelector, e.what());
         return 0;
     }
-
-    return g_hookedModuleId;
 }
 
 PyObject* AddBrowserCss(PyObject* self, PyObject* args) 
@@ -287,4 +278,4 @@ PyMethodDef* GetMillenniumModule()
 void SetPluginLoader(std::shared_ptr<PluginLoader> pluginLoader) 
 {
     g_pluginLoader = pluginLoader;
-}
\ No newline at end of file
+}
\ No newline at end of file
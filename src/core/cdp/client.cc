@@ -0,0 +1,228 @@
+#include "client.h"
+#include <core/loader.h>
+#include <sys/log.h>
+
+long long CDP::Client::NextMessageId()
+{
+    return m_nextMessageId.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string CDP::Client::GetSharedSessionId()
+{
+    return Sockets::GetSharedSessionId();
+}
+
+long long CDP::Client::Post(long long messageId, Method method, std::string payload, ResponseHandler handler, std::string_view sessionId)
+{
+    const bool awaitsResponse = handler != nullptr;
+
+    // register before sending, the response can arrive on the socket thread before Post returns.
+    if (awaitsResponse)
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        m_pendingRequests.emplace(messageId, PendingRequest { method, std::string(sessionId), std::move(handler) });
+    }
+
+    if (!Sockets::PostPayload(std::move(payload), GetLaneForMethod(method), awaitsResponse ? messageId : 0))
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        m_pendingRequests.erase(messageId);
+        return 0;
+    }
+    return messageId;
+}
+
+bool CDP::Client::Cancel(long long messageId)
+{
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    return m_pendingRequests.erase(messageId) != 0;
+}
+
+void CDP::Client::FailPending(std::vector<std::pair<long long, PendingRequest>> requests, const std::string& reason)
+{
+    for (auto& [messageId, request] : requests)
+    {
+        const Message errorMessage(nlohmann::json({
+            { "id", messageId },
+            { "error", { { "code", -32000 }, { "message", reason } } }
+        }).dump());
+
+        try
+        {
+            request.handler(errorMessage);
+        }
+        catch (const std::exception& ex)
+        {
+            LOG_ERROR("error failing CDP request {} ({}) -> {}", messageId, GetMethodName(request.method), ex.what());
+        }
+    }
+}
+
+void CDP::Client::Fail(const std::vector<long long>& messageIds, const std::string& reason)
+{
+    std::vector<std::pair<long long, PendingRequest>> failedRequests;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+
+        for (const long long messageId : messageIds)
+        {
+            auto it = m_pendingRequests.find(messageId);
+
+            if (it != m_pendingRequests.end())
+            {
+                failedRequests.emplace_back(messageId, std::move(it->second));
+                m_pendingRequests.erase(it);
+            }
+        }
+    }
+    this->FailPending(std::move(failedRequests), reason);
+}
+
+void CDP::Client::FailSession(const std::string& sessionId, const std::string& reason)
+{
+    if (sessionId.empty())
+    {
+        return;
+    }
+
+    std::vector<std::pair<long long, PendingRequest>> failedRequests;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+
+        for (auto it = m_pendingRequests.begin(); it != m_pendingRequests.end();)
+        {
+            if (it->second.sessionId == sessionId)
+            {
+                failedRequests.emplace_back(it->first, std::move(it->second));
+                it = m_pendingRequests.erase(it);
+            }
+            else ++it;
+        }
+    }
+
+    if (!failedRequests.empty())
+    {
+        Logger.Warn("Failing {} pending CDP request(s) on session {}: {}", failedRequests.size(), sessionId, reason);
+    }
+    this->FailPending(std::move(failedRequests), reason);
+}
+
+unsigned long long CDP::Client::Subscribe(Method method, EventHandler handler)
+{
+    const unsigned long long subscriberId = m_nextSubscriberId.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(m_subscriberMutex);
+    m_subscribers[(std::size_t)method].push_back({ subscriberId, std::move(handler) });
+    return subscriberId;
+}
+
+void CDP::Client::Unsubscribe(Method method, unsigned long long subscriberId)
+{
+    std::lock_guard<std::mutex> lock(m_subscriberMutex);
+    auto& subscribers = m_subscribers[(std::size_t)method];
+
+    subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(), [subscriberId](const Subscriber& subscriber) {
+        return subscriber.id == subscriberId;
+    }), subscribers.end());
+}
+
+bool CDP::Client::DispatchResponse(long long messageId, const Message& message)
+{
+    ResponseHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        auto it = m_pendingRequests.find(messageId);
+
+        if (it == m_pendingRequests.end())
+        {
+            return false;
+        }
+
+        handler = std::move(it->second.handler);
+        m_pendingRequests.erase(it);
+    }
+
+    try
+    {
+        handler(message);
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR("error handling response to CDP request {} -> {}", messageId, ex.what());
+    }
+    return true;
+}
+
+bool CDP::Client::DispatchEvent(Method method, const Message& message)
+{
+    std::vector<Subscriber> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(m_subscriberMutex);
+        const auto& methodSubscribers = m_subscribers[(std::size_t)method];
+
+        if (methodSubscribers.empty())
+        {
+            return false;
+        }
+
+        // copy out so handlers are free to (un)subscribe while being invoked.
+        subscribers = methodSubscribers;
+    }
+
+    for (const auto& subscriber : subscribers)
+    {
+        try
+        {
+            subscriber.handler(message);
+        }
+        catch (const std::exception& ex)
+        {
+            LOG_ERROR("error handling CDP event {} -> {}", GetMethodName(method), ex.what());
+        }
+    }
+    return true;
+}
+
+bool CDP::Client::Dispatch(const Message& message)
+{
+    if (message.HasId())
+    {
+        return this->DispatchResponse(message.Id(), message);
+    }
+
+    const Method method = ParseMethod(message.Method());
+
+    // nobody can be subscribed to a method that isn't in the bindings.
+    if (method == Method::Unknown)
+    {
+        return false;
+    }
+    return this->DispatchEvent(method, message);
+}
+
+void CDP::Client::Reset()
+{
+    std::vector<std::pair<long long, PendingRequest>> failedRequests;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        failedRequests.reserve(m_pendingRequests.size());
+
+        for (auto& [messageId, request] : m_pendingRequests)
+        {
+            failedRequests.emplace_back(messageId, std::move(request));
+        }
+        m_pendingRequests.clear();
+    }
+
+    if (!failedRequests.empty())
+    {
+        Logger.Warn("Failing {} pending CDP request(s), the browser connection was closed...", failedRequests.size());
+    }
+    this->FailPending(std::move(failedRequests), "browser connection closed");
+}
+
+std::size_t CDP::Client::PendingCount()
+{
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    return m_pendingRequests.size();
+}
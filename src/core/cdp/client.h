@@ -0,0 +1,114 @@
+#pragma once
+#include <core/cdp/message.h>
+#include <core/cdp/protocol.h>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <array>
+#include <string>
+#include <mutex>
+#include <atomic>
+
+namespace CDP
+{
+    using ResponseHandler = std::function<void(const Message& response)>;
+    using EventHandler    = std::function<void(const Message& event)>;
+
+    /**
+     * Routes DevTools traffic by correlation id instead of broadcasting every message to every listener.
+     * Requests are handed a unique id and their handler is stored against it, so a response is delivered
+     * to exactly one caller with a single hash lookup. Events are delivered to subscribers indexed by their
+     * generated Method, see protocol.h. Routing only reads the top level of a message, handlers decide how much
+     * of it to materialize.
+     */
+    class Client
+    {
+    private:
+        Client() {}
+
+        struct PendingRequest
+        {
+            Method method;
+            std::string sessionId;
+            ResponseHandler handler;
+        };
+
+        struct Subscriber
+        {
+            unsigned long long id;
+            EventHandler handler;
+        };
+
+        std::atomic<long long> m_nextMessageId { 1 };
+        std::atomic<unsigned long long> m_nextSubscriberId { 1 };
+
+        std::mutex m_pendingMutex;
+        std::unordered_map<long long, PendingRequest> m_pendingRequests;
+
+        std::mutex m_subscriberMutex;
+        std::array<std::vector<Subscriber>, (std::size_t)Method::Count> m_subscribers;
+
+        long long Post(long long messageId, Method method, std::string payload, ResponseHandler handler, std::string_view sessionId);
+        std::string GetSharedSessionId();
+        void FailPending(std::vector<std::pair<long long, PendingRequest>> requests, const std::string& reason);
+
+        bool DispatchResponse(long long messageId, const Message& message);
+        bool DispatchEvent(Method method, const Message& message);
+
+    public:
+        Client(const Client&) = delete;
+        Client& operator=(const Client&) = delete;
+
+        static Client& InstanceRef()
+        {
+            static Client InstanceRef;
+            return InstanceRef;
+        }
+
+        long long NextMessageId();
+
+        /// @brief send a command on the browser connection, or on a flattened session if a sessionId is given.
+        /// @return the id of the request, or 0 if the socket isn't connected, in which case the handler is never called.
+        template <typename Command>
+        long long Send(const Command& command, ResponseHandler handler = nullptr, std::string_view sessionId = {})
+        {
+            const long long messageId = this->NextMessageId();
+            return this->Post(messageId, Command::method, Serialize(messageId, command, sessionId), std::move(handler), sessionId);
+        }
+
+        /// @brief send a command to the SharedJSContext session.
+        template <typename Command>
+        long long SendShared(const Command& command, ResponseHandler handler = nullptr)
+        {
+            const std::string sessionId = this->GetSharedSessionId();
+
+            if (sessionId.empty())
+            {
+                return 0;
+            }
+            return this->Send(command, std::move(handler), sessionId);
+        }
+
+        /// @brief forget a pending request, i.e when its caller stopped waiting on it.
+        /// @return false if the response was already dispatched.
+        bool Cancel(long long messageId);
+
+        /// @brief fail the given requests with a synthesized CDP error, ids that aren't pending are ignored.
+        void Fail(const std::vector<long long>& messageIds, const std::string& reason);
+
+        /// @brief fail every request pending on a session with a synthesized CDP error, so callers don't wait on a dead session.
+        void FailSession(const std::string& sessionId, const std::string& reason);
+
+        unsigned long long Subscribe(Method method, EventHandler handler);
+        void Unsubscribe(Method method, unsigned long long subscriberId);
+
+        /// @brief route an inbound message to the request that owns its id, or to the subscribers of its method.
+        /// @return true if the message had an owner.
+        bool Dispatch(const Message& message);
+
+        /// @brief fail all pending requests, used when the browser connection is torn down.
+        void Reset();
+
+        std::size_t PendingCount();
+    };
+}
@@ -0,0 +1,295 @@
+#include "message.h"
+#include <cstring>
+#include <charconv>
+
+namespace
+{
+    inline const char* SkipWhitespace(const char* it, const char* end)
+    {
+        while (it < end && (*it == ' ' || *it == '\n' || *it == '\r' || *it == '\t'))
+        {
+            it++;
+        }
+        return it;
+    }
+
+    /* `it` points at the opening quote. returns one past the closing quote, or nullptr if the string never ends. */
+    const char* SkipString(const char* it, const char* end, bool* hasEscape = nullptr)
+    {
+        const char* begin = ++it;
+
+        while (it < end)
+        {
+            // base64 bodies are megabytes long, so hop between quotes rather than walking every byte.
+            const char* quote = static_cast<const char*>(std::memchr(it, '"', end - it));
+
+            if (quote == nullptr)
+            {
+                return nullptr;
+            }
+
+            std::size_t backslashes = 0;
+            for (const char* back = quote - 1; back >= begin && *back == '\\'; back--)
+            {
+                backslashes++;
+            }
+
+            if (backslashes % 2 == 0)
+            {
+                if (hasEscape != nullptr)
+                {
+                    *hasEscape = std::memchr(begin, '\\', quote - begin) != nullptr;
+                }
+                return quote + 1;
+            }
+            it = quote + 1;
+        }
+        return nullptr;
+    }
+
+    /* `it` points at the first character of a value. returns one past its end, or nullptr on malformed input. */
+    const char* SkipValue(const char* it, const char* end)
+    {
+        if (it >= end)
+        {
+            return nullptr;
+        }
+
+        if (*it == '"')
+        {
+            return SkipString(it, end);
+        }
+
+        if (*it == '{' || *it == '[')
+        {
+            std::size_t depth = 0;
+
+            while (it < end)
+            {
+                switch (*it)
+                {
+                    case '"':
+                    {
+                        it = SkipString(it, end);
+
+                        if (it == nullptr)
+                        {
+                            return nullptr;
+                        }
+                        continue;
+                    }
+                    case '{': case '[': { depth++; break; }
+                    case '}': case ']':
+                    {
+                        if (--depth == 0)
+                        {
+                            return it + 1;
+                        }
+                        break;
+                    }
+                }
+                it++;
+            }
+            return nullptr;
+        }
+
+        // numbers, true, false & null
+        while (it < end && *it != ',' && *it != '}' && *it != ']' && *it != ' ' && *it != '\n' && *it != '\r' && *it != '\t')
+        {
+            it++;
+        }
+        return it;
+    }
+
+    /**
+     * Walk the members of the object starting at `it` (which must point at '{'), calling visitor(key, valueBegin, valueEnd)
+     * for each one. The visitor returns false to stop early. Returns false on malformed input.
+     */
+    template <typename Visitor>
+    bool VisitObject(const char* it, const char* end, Visitor&& visitor)
+    {
+        it = SkipWhitespace(it, end);
+
+        if (it >= end || *it != '{')
+        {
+            return false;
+        }
+
+        it = SkipWhitespace(it + 1, end);
+
+        if (it < end && *it == '}')
+        {
+            return true;
+        }
+
+        while (it < end)
+        {
+            if (*it != '"')
+            {
+                return false;
+            }
+
+            const char* keyEnd = SkipString(it, end);
+
+            if (keyEnd == nullptr)
+            {
+                return false;
+            }
+
+            const std::string_view key(it + 1, keyEnd - it - 2);
+            it = SkipWhitespace(keyEnd, end);
+
+            if (it >= end || *it != ':')
+            {
+                return false;
+            }
+
+            const char* valueBegin = SkipWhitespace(it + 1, end);
+            const char* valueEnd = SkipValue(valueBegin, end);
+
+            if (valueEnd == nullptr)
+            {
+                return false;
+            }
+
+            if (!visitor(key, valueBegin, valueEnd))
+            {
+                return true;
+            }
+
+            it = SkipWhitespace(valueEnd, end);
+
+            if (it < end && *it == ',')
+            {
+                it = SkipWhitespace(it + 1, end);
+                continue;
+            }
+            return it < end && *it == '}';
+        }
+        return false;
+    }
+
+    std::optional<std::string_view> AsString(std::string_view raw)
+    {
+        if (raw.size() < 2 || raw.front() != '"' || raw.find('\\') != std::string_view::npos)
+        {
+            return std::nullopt;
+        }
+        return raw.substr(1, raw.size() - 2);
+    }
+
+    std::optional<long long> AsInteger(std::string_view raw)
+    {
+        long long value = 0;
+        const auto [ptr, errorCode] = std::from_chars(raw.data(), raw.data() + raw.size(), value);
+
+        if (errorCode != std::errc() || ptr != raw.data() + raw.size())
+        {
+            return std::nullopt;
+        }
+        return value;
+    }
+}
+
+CDP::Message::Message(std::string payload) : m_ownedPayload(std::move(payload))
+{
+    m_payload = m_ownedPayload;
+    this->ScanTopLevel();
+}
+
+CDP::Message::Message(std::string_view payload, std::shared_ptr<const void> owner) : m_owner(std::move(owner)), m_payload(payload)
+{
+    this->ScanTopLevel();
+}
+
+void CDP::Message::ScanTopLevel()
+{
+    const char* begin = m_payload.data();
+    const char* end = begin + m_payload.size();
+
+    m_isValid = VisitObject(begin, end, [this](std::string_view key, const char* valueBegin, const char* valueEnd)
+    {
+        const std::string_view raw(valueBegin, valueEnd - valueBegin);
+
+        if (key == "id")
+        {
+            const auto id = AsInteger(raw);
+            m_hasId = id.has_value();
+            m_id = id.value_or(0);
+        }
+        else if (key == "method")
+        {
+            m_method = AsString(raw).value_or(std::string_view());
+        }
+        else if (key == "sessionId")
+        {
+            m_sessionId = AsString(raw).value_or(std::string_view());
+        }
+        else if (key == "error")
+        {
+            m_hasError = true;
+        }
+        return true;
+    });
+}
+
+std::optional<std::string_view> CDP::Message::FindRaw(std::initializer_list<std::string_view> path) const
+{
+    const char* end = m_payload.data() + m_payload.size();
+    std::string_view current = m_payload;
+
+    for (const auto& segment : path)
+    {
+        std::optional<std::string_view> member;
+
+        const bool isValid = VisitObject(current.data(), end, [&](std::string_view key, const char* valueBegin, const char* valueEnd)
+        {
+            if (key != segment)
+            {
+                return true;
+            }
+
+            member = std::string_view(valueBegin, valueEnd - valueBegin);
+            return false;
+        });
+
+        if (!isValid || !member.has_value())
+        {
+            return std::nullopt;
+        }
+        current = *member;
+    }
+    return current;
+}
+
+std::optional<std::string_view> CDP::Message::FindString(std::initializer_list<std::string_view> path) const
+{
+    const auto raw = this->FindRaw(path);
+    return raw.has_value() ? AsString(*raw) : std::nullopt;
+}
+
+std::optional<bool> CDP::Message::FindBool(std::initializer_list<std::string_view> path) const
+{
+    const auto raw = this->FindRaw(path);
+
+    if (!raw.has_value() || (*raw != "true" && *raw != "false"))
+    {
+        return std::nullopt;
+    }
+    return *raw == "true";
+}
+
+std::optional<long long> CDP::Message::FindInteger(std::initializer_list<std::string_view> path) const
+{
+    const auto raw = this->FindRaw(path);
+    return raw.has_value() ? AsInteger(*raw) : std::nullopt;
+}
+
+const nlohmann::json& CDP::Message::Json() const
+{
+    if (!m_json)
+    {
+        m_json = std::make_unique<nlohmann::json>(nlohmann::json::parse(m_payload.begin(), m_payload.end()));
+    }
+    return *m_json;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <memory>
+#include <initializer_list>
+
+namespace CDP
+{
+    /**
+     * An inbound DevTools message that is only parsed on demand.
+     *
+     * Construction does a single shallow pass over the top level object to pick up `id`, `method`, `sessionId`
+     * and whether an `error` is present, skipping every other value without building anything. Nested fields can
+     * be read as views straight into the receive buffer with Find*, and the full nlohmann DOM is only built if a
+     * handler asks for it through Json().
+     *
+     * Views returned by a Message are only valid for as long as the message is, and a Message is not thread-safe.
+     */
+    class Message
+    {
+    public:
+        explicit Message(std::string payload);
+        Message(std::string_view payload, std::shared_ptr<const void> owner);
+
+        Message(const Message&) = delete;
+        Message& operator=(const Message&) = delete;
+
+        bool IsValid() const { return m_isValid; }
+
+        bool HasId() const { return m_hasId; }
+        long long Id() const { return m_id; }
+        bool HasError() const { return m_hasError; }
+
+        std::string_view Method() const { return m_method; }
+        std::string_view SessionId() const { return m_sessionId; }
+        std::string_view Payload() const { return m_payload; }
+
+        /// @brief find the raw json text of a nested value, i.e { "result", "body" }
+        std::optional<std::string_view> FindRaw(std::initializer_list<std::string_view> path) const;
+
+        /// @brief find a nested string as a view into the payload. strings that contain escape sequences can't be
+        /// represented as a view, those return nullopt and have to be read through Json() instead.
+        std::optional<std::string_view> FindString(std::initializer_list<std::string_view> path) const;
+
+        std::optional<bool> FindBool(std::initializer_list<std::string_view> path) const;
+        std::optional<long long> FindInteger(std::initializer_list<std::string_view> path) const;
+
+        /// @brief materialize (once) and return the full message.
+        const nlohmann::json& Json() const;
+
+    private:
+        void ScanTopLevel();
+
+        std::string m_ownedPayload;
+        std::shared_ptr<const void> m_owner;
+        std::string_view m_payload;
+
+        bool m_isValid = false;
+        bool m_hasId = false;
+        bool m_hasError = false;
+        long long m_id = 0;
+        std::string_view m_method, m_sessionId;
+
+        mutable std::unique_ptr<nlohmann::json> m_json;
+    };
+}
@@ -0,0 +1,779 @@
+// Generated by scripts/cdp/generate_bindings.py from scripts/cdp/protocol.json, do not edit by hand.
+#pragma once
+#include <core/cdp/writer.h>
+
+namespace CDP
+{
+    enum class Method : unsigned short
+    {
+        Unknown,
+        Console_enable,
+        Console_messageAdded,
+        Debugger_enable,
+        Debugger_pause,
+        Debugger_paused,
+        Debugger_resume,
+        Fetch_continueRequest,
+        Fetch_disable,
+        Fetch_enable,
+        Fetch_failRequest,
+        Fetch_fulfillRequest,
+        Fetch_getResponseBody,
+        Fetch_requestPaused,
+        Fetch_takeResponseBodyAsStream,
+        IO_close,
+        IO_read,
+        Page_addScriptToEvaluateOnNewDocument,
+        Page_enable,
+        Page_reload,
+        Page_removeScriptToEvaluateOnNewDocument,
+        Page_setBypassCSP,
+        Runtime_evaluate,
+        Target_attachToTarget,
+        Target_attachedToTarget,
+        Target_detachedFromTarget,
+        Target_getTargets,
+        Target_setDiscoverTargets,
+        Target_targetCreated,
+        Target_targetDestroyed,
+        Target_targetInfoChanged,
+        Count
+    };
+
+    inline constexpr std::string_view MethodNames[] =
+    {
+        "",
+        "Console.enable",
+        "Console.messageAdded",
+        "Debugger.enable",
+        "Debugger.pause",
+        "Debugger.paused",
+        "Debugger.resume",
+        "Fetch.continueRequest",
+        "Fetch.disable",
+        "Fetch.enable",
+        "Fetch.failRequest",
+        "Fetch.fulfillRequest",
+        "Fetch.getResponseBody",
+        "Fetch.requestPaused",
+        "Fetch.takeResponseBodyAsStream",
+        "IO.close",
+        "IO.read",
+        "Page.addScriptToEvaluateOnNewDocument",
+        "Page.enable",
+        "Page.reload",
+        "Page.removeScriptToEvaluateOnNewDocument",
+        "Page.setBypassCSP",
+        "Runtime.evaluate",
+        "Target.attachToTarget",
+        "Target.attachedToTarget",
+        "Target.detachedFromTarget",
+        "Target.getTargets",
+        "Target.setDiscoverTargets",
+        "Target.targetCreated",
+        "Target.targetDestroyed",
+        "Target.targetInfoChanged",
+    };
+
+    constexpr std::string_view GetMethodName(Method method)
+    {
+        return MethodNames[(std::size_t)method];
+    }
+
+    /// @brief resolve a method name by switching on its length and then on the characters that tell the
+    /// candidates apart, so a name is confirmed with a single compare and never hashed.
+    inline Method ParseMethod(std::string_view name)
+    {
+        switch (name.size())
+        {
+            case 7:
+            {
+                return name == "IO.read" ? Method::IO_read : Method::Unknown;
+            }
+            case 8:
+            {
+                return name == "IO.close" ? Method::IO_close : Method::Unknown;
+            }
+            case 11:
+            {
+                switch (name[5])
+                {
+                    case 'e':
+                    {
+                        return name == "Page.enable" ? Method::Page_enable : Method::Unknown;
+                    }
+                    case 'r':
+                    {
+                        return name == "Page.reload" ? Method::Page_reload : Method::Unknown;
+                    }
+                }
+                return Method::Unknown;
+            }
+            case 12:
+            {
+                return name == "Fetch.enable" ? Method::Fetch_enable : Method::Unknown;
+            }
+            case 13:
+            {
+                return name == "Fetch.disable" ? Method::Fetch_disable : Method::Unknown;
+            }
+            case 14:
+            {
+                switch (name[0])
+                {
+                    case 'C':
+                    {
+                        return name == "Console.enable" ? Method::Console_enable : Method::Unknown;
+                    }
+                    case 'D':
+                    {
+                        return name == "Debugger.pause" ? Method::Debugger_pause : Method::Unknown;
+                    }
+                }
+                return Method::Unknown;
+            }
+            case 15:
+            {
+                switch (name[9])
+                {
+                    case 'e':
+                    {
+                        return name == "Debugger.enable" ? Method::Debugger_enable : Method::Unknown;
+                    }
+                    case 'p':
+                    {
+                        return name == "Debugger.paused" ? Method::Debugger_paused : Method::Unknown;
+                    }
+                    case 'r':
+                    {
+                        return name == "Debugger.resume" ? Method::Debugger_resume : Method::Unknown;
+                    }
+                }
+                return Method::Unknown;
+            }
+            case 16:
+            {
+                return name == "Runtime.evaluate" ? Method::Runtime_evaluate : Method::Unknown;
+            }
+            case 17:
+            {
+                switch (name[0])
+                {
+                    case 'F':
+                    {
+                        return name == "Fetch.failRequest" ? Method::Fetch_failRequest : Method::Unknown;
+                    }
+                    case 'P':
+                    {
+                        return name == "Page.setBypassCSP" ? Method::Page_setBypassCSP : Method::Unknown;
+                    }
+                    case 'T':
+                    {
+                        return name == "Target.getTargets" ? Method::Target_getTargets : Method::Unknown;
+                    }
+                }
+                return Method::Unknown;
+            }
+            case 19:
+            {
+                return name == "Fetch.requestPaused" ? Method::Fetch_requestPaused : Method::Unknown;
+            }
+            case 20:
+            {
+                switch (name[0])
+                {
+                    case 'C':
+                    {
+                        return name == "Console.messageAdded" ? Method::Console_messageAdded : Method::Unknown;
+                    }
+                    case 'F':
+                    {
+                        return name == "Fetch.fulfillRequest" ? Method::Fetch_fulfillRequest : Method::Unknown;
+                    }
+                    case 'T':
+                    {
+                        return name == "Target.targetCreated" ? Method::Target_targetCreated : Method::Unknown;
+                    }
+                }
+                return Method::Unknown;
+            }
+            case 21:
+            {
+                switch (name[6])
+                {
+                    case '.':
+                    {
+                        return name == "Target.attachToTarget" ? Method::Target_attachToTarget : Method::Unknown;
+                    }
+                    case 'c':
+                    {
+                        return name == "Fetch.continueRequest" ? Method::Fetch_continueRequest : Method::Unknown;
+                    }
+                    case 'g':
+                    {
+                        return name == "Fetch.getResponseBody" ? Method::Fetch_getResponseBody : Method::Unknown;
+                    }
+                }
+                return Method::Unknown;
+            }
+            case 22:
+            {
+                return name == "Target.targetDestroyed" ? Method::Target_targetDestroyed : Method::Unknown;
+            }
+            case 23:
+            {
+                return name == "Target.attachedToTarget" ? Method::Target_attachedToTarget : Method::Unknown;
+            }
+            case 24:
+            {
+                return name == "Target.targetInfoChanged" ? Method::Target_targetInfoChanged : Method::Unknown;
+            }
+            case 25:
+            {
+                switch (name[7])
+                {
+                    case 'd':
+                    {
+                        return name == "Target.detachedFromTarget" ? Method::Target_detachedFromTarget : Method::Unknown;
+                    }
+                    case 's':
+                    {
+                        return name == "Target.setDiscoverTargets" ? Method::Target_setDiscoverTargets : Method::Unknown;
+                    }
+                }
+                return Method::Unknown;
+            }
+            case 30:
+            {
+                return name == "Fetch.takeResponseBodyAsStream" ? Method::Fetch_takeResponseBodyAsStream : Method::Unknown;
+            }
+            case 37:
+            {
+                return name == "Page.addScriptToEvaluateOnNewDocument" ? Method::Page_addScriptToEvaluateOnNewDocument : Method::Unknown;
+            }
+            case 40:
+            {
+                return name == "Page.removeScriptToEvaluateOnNewDocument" ? Method::Page_removeScriptToEvaluateOnNewDocument : Method::Unknown;
+            }
+        }
+        return Method::Unknown;
+    }
+
+    namespace Console
+    {
+        using CDP::Write;
+        using CDP::EstimateSize;
+
+        struct Enable
+        {
+            static constexpr Method method = Method::Console_enable;
+        };
+
+        inline void Write(Writer& writer, const Enable&)
+        {
+            writer.BeginObject();
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const Enable&)
+        {
+            return 2;
+        }
+    }
+
+    namespace Debugger
+    {
+        using CDP::Write;
+        using CDP::EstimateSize;
+
+        struct Enable
+        {
+            static constexpr Method method = Method::Debugger_enable;
+        };
+
+        inline void Write(Writer& writer, const Enable&)
+        {
+            writer.BeginObject();
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const Enable&)
+        {
+            return 2;
+        }
+
+        struct Pause
+        {
+            static constexpr Method method = Method::Debugger_pause;
+        };
+
+        inline void Write(Writer& writer, const Pause&)
+        {
+            writer.BeginObject();
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const Pause&)
+        {
+            return 2;
+        }
+
+        struct Resume
+        {
+            static constexpr Method method = Method::Debugger_resume;
+        };
+
+        inline void Write(Writer& writer, const Resume&)
+        {
+            writer.BeginObject();
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const Resume&)
+        {
+            return 2;
+        }
+    }
+
+    namespace Fetch
+    {
+        using CDP::Write;
+        using CDP::EstimateSize;
+
+        struct RequestPattern
+        {
+            std::optional<std::string_view> urlPattern;
+            std::optional<std::string_view> resourceType;
+            std::optional<std::string_view> requestStage;
+        };
+
+        inline void Write(Writer& writer, const RequestPattern& value)
+        {
+            writer.BeginObject();
+            if (value.urlPattern) { writer.Key("urlPattern"); Write(writer, *value.urlPattern); }
+            if (value.resourceType) { writer.Key("resourceType"); Write(writer, *value.resourceType); }
+            if (value.requestStage) { writer.Key("requestStage"); Write(writer, *value.requestStage); }
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const RequestPattern& value)
+        {
+            return 2 + EstimateSize(value.urlPattern) + 14 + EstimateSize(value.resourceType) + 16 + EstimateSize(value.requestStage) + 16;
+        }
+
+        struct HeaderEntry
+        {
+            std::string_view name;
+            std::string_view value;
+        };
+
+        inline void Write(Writer& writer, const HeaderEntry& value)
+        {
+            writer.BeginObject();
+            writer.Key("name"); Write(writer, value.name);
+            writer.Key("value"); Write(writer, value.value);
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const HeaderEntry& value)
+        {
+            return 2 + EstimateSize(value.name) + 8 + EstimateSize(value.value) + 9;
+        }
+
+        struct Enable
+        {
+            static constexpr Method method = Method::Fetch_enable;
+
+            std::optional<std::vector<RequestPattern>> patterns;
+            std::optional<bool> handleAuthRequests;
+        };
+
+        inline void Write(Writer& writer, const Enable& value)
+        {
+            writer.BeginObject();
+            if (value.patterns) { writer.Key("patterns"); Write(writer, *value.patterns); }
+            if (value.handleAuthRequests) { writer.Key("handleAuthRequests"); Write(writer, *value.handleAuthRequests); }
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const Enable& value)
+        {
+            return 2 + EstimateSize(value.patterns) + 12 + EstimateSize(value.handleAuthRequests) + 22;
+        }
+
+        struct Disable
+        {
+            static constexpr Method method = Method::Fetch_disable;
+        };
+
+        inline void Write(Writer& writer, const Disable&)
+        {
+            writer.BeginObject();
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const Disable&)
+        {
+            return 2;
+        }
+
+        struct ContinueRequest
+        {
+            static constexpr Method method = Method::Fetch_continueRequest;
+
+            std::string_view requestId;
+        };
+
+        inline void Write(Writer& writer, const ContinueRequest& value)
+        {
+            writer.BeginObject();
+            writer.Key("requestId"); Write(writer, value.requestId);
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const ContinueRequest& value)
+        {
+            return 2 + EstimateSize(value.requestId) + 13;
+        }
+
+        struct FulfillRequest
+        {
+            static constexpr Method method = Method::Fetch_fulfillRequest;
+
+            std::string_view requestId;
+            long long responseCode = 0;
+            std::optional<std::vector<HeaderEntry>> responseHeaders;
+            std::optional<std::string_view> body;
+            std::optional<std::string_view> responsePhrase;
+        };
+
+        inline void Write(Writer& writer, const FulfillRequest& value)
+        {
+            writer.BeginObject();
+            writer.Key("requestId"); Write(writer, value.requestId);
+            writer.Key("responseCode"); Write(writer, value.responseCode);
+            if (value.responseHeaders) { writer.Key("responseHeaders"); Write(writer, *value.responseHeaders); }
+            if (value.body) { writer.Key("body"); Write(writer, *value.body); }
+            if (value.responsePhrase) { writer.Key("responsePhrase"); Write(writer, *value.responsePhrase); }
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const FulfillRequest& value)
+        {
+            return 2 + EstimateSize(value.requestId) + 13 + EstimateSize(value.responseCode) + 16 + EstimateSize(value.responseHeaders) + 19 + EstimateSize(value.body) + 8 + EstimateSize(value.responsePhrase) + 18;
+        }
+
+        struct GetResponseBody
+        {
+            static constexpr Method method = Method::Fetch_getResponseBody;
+
+            std::string_view requestId;
+        };
+
+        inline void Write(Writer& writer, const GetResponseBody& value)
+        {
+            writer.BeginObject();
+            writer.Key("requestId"); Write(writer, value.requestId);
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const GetResponseBody& value)
+        {
+            return 2 + EstimateSize(value.requestId) + 13;
+        }
+
+        struct TakeResponseBodyAsStream
+        {
+            static constexpr Method method = Method::Fetch_takeResponseBodyAsStream;
+
+            std::string_view requestId;
+        };
+
+        inline void Write(Writer& writer, const TakeResponseBodyAsStream& value)
+        {
+            writer.BeginObject();
+            writer.Key("requestId"); Write(writer, value.requestId);
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const TakeResponseBodyAsStream& value)
+        {
+            return 2 + EstimateSize(value.requestId) + 13;
+        }
+
+        struct FailRequest
+        {
+            static constexpr Method method = Method::Fetch_failRequest;
+
+            std::string_view requestId;
+            std::string_view errorReason;
+        };
+
+        inline void Write(Writer& writer, const FailRequest& value)
+        {
+            writer.BeginObject();
+            writer.Key("requestId"); Write(writer, value.requestId);
+            writer.Key("errorReason"); Write(writer, value.errorReason);
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const FailRequest& value)
+        {
+            return 2 + EstimateSize(value.requestId) + 13 + EstimateSize(value.errorReason) + 15;
+        }
+    }
+
+    namespace IO
+    {
+        using CDP::Write;
+        using CDP::EstimateSize;
+
+        struct Read
+        {
+            static constexpr Method method = Method::IO_read;
+
+            std::string_view handle;
+            std::optional<long long> offset;
+            std::optional<long long> size;
+        };
+
+        inline void Write(Writer& writer, const Read& value)
+        {
+            writer.BeginObject();
+            writer.Key("handle"); Write(writer, value.handle);
+            if (value.offset) { writer.Key("offset"); Write(writer, *value.offset); }
+            if (value.size) { writer.Key("size"); Write(writer, *value.size); }
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const Read& value)
+        {
+            return 2 + EstimateSize(value.handle) + 10 + EstimateSize(value.offset) + 10 + EstimateSize(value.size) + 8;
+        }
+
+        struct Close
+        {
+            static constexpr Method method = Method::IO_close;
+
+            std::string_view handle;
+        };
+
+        inline void Write(Writer& writer, const Close& value)
+        {
+            writer.BeginObject();
+            writer.Key("handle"); Write(writer, value.handle);
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const Close& value)
+        {
+            return 2 + EstimateSize(value.handle) + 10;
+        }
+    }
+
+    namespace Page
+    {
+        using CDP::Write;
+        using CDP::EstimateSize;
+
+        struct Enable
+        {
+            static constexpr Method method = Method::Page_enable;
+        };
+
+        inline void Write(Writer& writer, const Enable&)
+        {
+            writer.BeginObject();
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const Enable&)
+        {
+            return 2;
+        }
+
+        struct Reload
+        {
+            static constexpr Method method = Method::Page_reload;
+        };
+
+        inline void Write(Writer& writer, const Reload&)
+        {
+            writer.BeginObject();
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const Reload&)
+        {
+            return 2;
+        }
+
+        struct AddScriptToEvaluateOnNewDocument
+        {
+            static constexpr Method method = Method::Page_addScriptToEvaluateOnNewDocument;
+
+            std::string_view source;
+        };
+
+        inline void Write(Writer& writer, const AddScriptToEvaluateOnNewDocument& value)
+        {
+            writer.BeginObject();
+            writer.Key("source"); Write(writer, value.source);
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const AddScriptToEvaluateOnNewDocument& value)
+        {
+            return 2 + EstimateSize(value.source) + 10;
+        }
+
+        struct RemoveScriptToEvaluateOnNewDocument
+        {
+            static constexpr Method method = Method::Page_removeScriptToEvaluateOnNewDocument;
+
+            std::string_view identifier;
+        };
+
+        inline void Write(Writer& writer, const RemoveScriptToEvaluateOnNewDocument& value)
+        {
+            writer.BeginObject();
+            writer.Key("identifier"); Write(writer, value.identifier);
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const RemoveScriptToEvaluateOnNewDocument& value)
+        {
+            return 2 + EstimateSize(value.identifier) + 14;
+        }
+
+        struct SetBypassCSP
+        {
+            static constexpr Method method = Method::Page_setBypassCSP;
+
+            bool enabled = false;
+        };
+
+        inline void Write(Writer& writer, const SetBypassCSP& value)
+        {
+            writer.BeginObject();
+            writer.Key("enabled"); Write(writer, value.enabled);
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const SetBypassCSP& value)
+        {
+            return 2 + EstimateSize(value.enabled) + 11;
+        }
+    }
+
+    namespace Runtime
+    {
+        using CDP::Write;
+        using CDP::EstimateSize;
+
+        struct Evaluate
+        {
+            static constexpr Method method = Method::Runtime_evaluate;
+
+            std::string_view expression;
+            std::optional<bool> returnByValue;
+            std::optional<bool> awaitPromise;
+        };
+
+        inline void Write(Writer& writer, const Evaluate& value)
+        {
+            writer.BeginObject();
+            writer.Key("expression"); Write(writer, value.expression);
+            if (value.returnByValue) { writer.Key("returnByValue"); Write(writer, *value.returnByValue); }
+            if (value.awaitPromise) { writer.Key("awaitPromise"); Write(writer, *value.awaitPromise); }
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const Evaluate& value)
+        {
+            return 2 + EstimateSize(value.expression) + 14 + EstimateSize(value.returnByValue) + 17 + EstimateSize(value.awaitPromise) + 16;
+        }
+    }
+
+    namespace Target
+    {
+        using CDP::Write;
+        using CDP::EstimateSize;
+
+        struct GetTargets
+        {
+            static constexpr Method method = Method::Target_getTargets;
+        };
+
+        inline void Write(Writer& writer, const GetTargets&)
+        {
+            writer.BeginObject();
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const GetTargets&)
+        {
+            return 2;
+        }
+
+        struct AttachToTarget
+        {
+            static constexpr Method method = Method::Target_attachToTarget;
+
+            std::string_view targetId;
+            std::optional<bool> flatten;
+        };
+
+        inline void Write(Writer& writer, const AttachToTarget& value)
+        {
+            writer.BeginObject();
+            writer.Key("targetId"); Write(writer, value.targetId);
+            if (value.flatten) { writer.Key("flatten"); Write(writer, *value.flatten); }
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const AttachToTarget& value)
+        {
+            return 2 + EstimateSize(value.targetId) + 12 + EstimateSize(value.flatten) + 11;
+        }
+
+        struct SetDiscoverTargets
+        {
+            static constexpr Method method = Method::Target_setDiscoverTargets;
+
+            bool discover = false;
+        };
+
+        inline void Write(Writer& writer, const SetDiscoverTargets& value)
+        {
+            writer.BeginObject();
+            writer.Key("discover"); Write(writer, value.discover);
+            writer.EndObject();
+        }
+
+        inline std::size_t EstimateSize(const SetDiscoverTargets& value)
+        {
+            return 2 + EstimateSize(value.discover) + 12;
+        }
+    }
+
+    /// @brief serialize a command into a ready to send message, sized up front so the buffer is allocated once.
+    template <typename Command>
+    std::string Serialize(long long messageId, const Command& command, std::string_view sessionId = {})
+    {
+        Writer writer(EstimateSize(command) + GetMethodName(Command::method).size() + sessionId.size() + 64);
+
+        writer.BeginObject();
+        writer.Key("id"); writer.Integer(messageId);
+        writer.Key("method"); writer.String(GetMethodName(Command::method));
+
+        if (!sessionId.empty())
+        {
+            writer.Key("sessionId"); writer.String(sessionId);
+        }
+
+        writer.Key("params"); Write(writer, command);
+        writer.EndObject();
+        return writer.Take();
+    }
+}
@@ -0,0 +1,195 @@
+#include "send_queue.h"
+#include <core/cdp/client.h>
+#include <sys/log.h>
+#include <vector>
+
+CDP::Lane CDP::GetLaneForMethod(Method method)
+{
+    switch (method)
+    {
+        case Method::Fetch_continueRequest:
+        case Method::Fetch_fulfillRequest:
+        case Method::Fetch_getResponseBody:
+        case Method::Fetch_takeResponseBodyAsStream:
+        case Method::Fetch_failRequest:
+        case Method::IO_read:
+        case Method::IO_close:
+        {
+            return Lane::Interception;
+        }
+        // only messages nothing else depends on, anything ordered against other requests must stay in the default lane.
+        case Method::Console_enable:
+        {
+            return Lane::Telemetry;
+        }
+        default:
+        {
+            return Lane::Default;
+        }
+    }
+}
+
+void CDP::SendQueue::Attach(BrowserClient* client, websocketpp::connection_hdl handle)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_client = client;
+    m_handle = handle;
+    // a drain posted to a previous, now destroyed io_context never ran.
+    m_drainScheduled = false;
+}
+
+void CDP::SendQueue::Detach()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto& lane : m_lanes)
+    {
+        m_metrics.droppedMessages += lane.size();
+        lane.clear();
+    }
+
+    m_client = nullptr;
+    m_handle.reset();
+    m_drainScheduled = false;
+
+    Logger.Log("CDP send queue: {} message(s) in {} batch(es), largest batch {}, peak depth {}, dropped {}",
+        m_metrics.sentMessages, m_metrics.sentBatches, m_metrics.largestBatch, m_metrics.peakDepth, m_metrics.droppedMessages);
+}
+
+bool CDP::SendQueue::Enqueue(std::string payload, Lane lane, long long messageId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_client == nullptr)
+    {
+        return false;
+    }
+
+    m_lanes[(std::size_t)lane].push_back({ messageId, std::move(payload) });
+
+    std::size_t depth = 0;
+    for (const auto& queuedLane : m_lanes)
+    {
+        depth += queuedLane.size();
+    }
+    m_metrics.peakDepth = std::max(m_metrics.peakDepth, depth);
+
+    this->ScheduleDrain();
+    return true;
+}
+
+/* expects m_mutex to be held */
+void CDP::SendQueue::ScheduleDrain()
+{
+    if (m_drainScheduled)
+    {
+        return;
+    }
+
+    m_drainScheduled = true;
+    asio::post(m_client->get_io_service(), [this] { this->Drain(); });
+}
+
+void CDP::SendQueue::Drain()
+{
+    std::vector<Outgoing> batch;
+    BrowserClient* client;
+    websocketpp::connection_hdl handle;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_drainScheduled = false;
+
+        if (m_client == nullptr)
+        {
+            return;
+        }
+
+        client = m_client;
+        handle = m_handle;
+
+        for (auto& lane : m_lanes)
+        {
+            std::move(lane.begin(), lane.end(), std::back_inserter(batch));
+            lane.clear();
+        }
+
+        m_metrics.largestBatch = std::max(m_metrics.largestBatch, batch.size());
+    }
+
+    std::size_t sentMessages = 0;
+    websocketpp::lib::error_code errorCode;
+
+    // we're on the socket thread, websocketpp queues these and flushes them together once this handler returns.
+    for (; sentMessages < batch.size(); sentMessages++)
+    {
+        client->send(handle, batch[sentMessages].payload, websocketpp::frame::opcode::text, errorCode);
+
+        if (errorCode)
+        {
+            LOG_ERROR("failed to send CDP message, dropping {} message(s) -> {}", batch.size() - sentMessages, errorCode.message());
+            break;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_metrics.sentMessages += sentMessages;
+        m_metrics.sentBatches += sentMessages != 0;
+        m_metrics.droppedMessages += batch.size() - sentMessages;
+    }
+
+    if (sentMessages == batch.size())
+    {
+        return;
+    }
+
+    // the connection is going down, don't leave the callers of what didn't make it waiting on a response.
+    std::vector<long long> unsentRequests;
+
+    for (std::size_t i = sentMessages; i < batch.size(); i++)
+    {
+        if (batch[i].messageId != 0)
+        {
+            unsentRequests.push_back(batch[i].messageId);
+        }
+    }
+    CDP::Client::InstanceRef().Fail(unsentRequests, fmt::format("failed to send message: {}", errorCode.message()));
+}
+
+void CDP::SendQueue::Close(const std::string& reason)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_client == nullptr)
+    {
+        return;
+    }
+
+    BrowserClient* client = m_client;
+    websocketpp::connection_hdl handle = m_handle;
+
+    asio::post(client->get_io_service(), [client, handle, reason]
+    {
+        try
+        {
+            client->close(handle, websocketpp::close::status::normal, reason);
+        }
+        catch (const websocketpp::exception& e)
+        {
+            LOG_ERROR("Failed to close browser connection: {}", e.what());
+        }
+    });
+}
+
+CDP::SendQueue::Metrics CDP::SendQueue::GetMetrics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Metrics metrics = m_metrics;
+
+    for (std::size_t i = 0; i < m_lanes.size(); i++)
+    {
+        metrics.depth[i] = m_lanes[i].size();
+    }
+    return metrics;
+}
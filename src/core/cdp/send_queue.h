@@ -0,0 +1,87 @@
+#pragma once
+#ifdef _WIN32
+#undef _WINSOCKAPI_
+#include <winsock2.h>
+#endif
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+#include <core/cdp/protocol.h>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <array>
+
+namespace CDP
+{
+    typedef websocketpp::client<websocketpp::config::asio_client> BrowserClient;
+
+    /** Lanes are drained highest priority first, FIFO within a lane. */
+    enum class Lane
+    {
+        Interception, // Fetch replies, the page load is stalled until these go out
+        Default,
+        Telemetry,    // Console housekeeping nobody is waiting on
+        Count
+    };
+
+    Lane GetLaneForMethod(Method method);
+
+    /**
+     * Every outbound DevTools message is serialized on the calling thread and queued here, then written from the
+     * socket's own io_context. Producers never touch the websocket, and a burst of messages queued between two
+     * drains is handed to websocketpp in one turn, which coalesces them into a single socket write.
+     */
+    class SendQueue
+    {
+    public:
+        struct Metrics
+        {
+            std::array<std::size_t, (std::size_t)Lane::Count> depth;
+            std::size_t peakDepth;
+            std::size_t largestBatch;
+            unsigned long long sentMessages;
+            unsigned long long sentBatches;
+            unsigned long long droppedMessages;
+        };
+
+        SendQueue(const SendQueue&) = delete;
+        SendQueue& operator=(const SendQueue&) = delete;
+
+        static SendQueue& InstanceRef()
+        {
+            static SendQueue InstanceRef;
+            return InstanceRef;
+        }
+
+        void Attach(BrowserClient* client, websocketpp::connection_hdl handle);
+        void Detach();
+
+        /// @param messageId the id of the request, so it can be failed through the client if it never makes it onto the socket.
+        /// @return false if there is no browser connection to send on.
+        bool Enqueue(std::string payload, Lane lane, long long messageId = 0);
+        void Close(const std::string& reason);
+
+        Metrics GetMetrics();
+
+    private:
+        SendQueue() {}
+
+        void ScheduleDrain();
+        void Drain();
+
+        std::mutex m_mutex;
+        BrowserClient* m_client = nullptr;
+        websocketpp::connection_hdl m_handle;
+
+        struct Outgoing
+        {
+            long long messageId;
+            std::string payload;
+        };
+
+        std::array<std::deque<Outgoing>, (std::size_t)Lane::Count> m_lanes;
+        bool m_drainScheduled = false;
+
+        Metrics m_metrics {};
+    };
+}
@@ -0,0 +1,203 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <optional>
+#include <vector>
+#include <cstring>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+namespace CDP
+{
+    /** Already serialized JSON that is copied into the output verbatim, i.e a value sliced out of an inbound Message. */
+    struct RawJson
+    {
+        std::string_view text;
+    };
+
+    /**
+     * Appends JSON straight into a string that the caller hands to the send queue, without building a DOM first.
+     * Used by the generated protocol bindings in protocol.h, commas are tracked per nesting level.
+     */
+    class Writer
+    {
+    public:
+        explicit Writer(std::size_t capacity)
+        {
+            m_buffer.reserve(capacity);
+        }
+
+        void BeginObject() { this->Separate(); m_buffer += '{'; this->Push(); }
+        void EndObject()   { m_buffer += '}'; m_depth--; }
+        void BeginArray()  { this->Separate(); m_buffer += '['; this->Push(); }
+        void EndArray()    { m_buffer += ']'; m_depth--; }
+
+        void Key(std::string_view key)
+        {
+            this->Separate();
+            m_buffer += '"';
+            m_buffer.append(key);
+            m_buffer += "\":";
+            // the value that follows the key must not get a comma of its own.
+            m_first[m_depth] = true;
+        }
+
+        void String(std::string_view value)
+        {
+            this->Separate();
+            m_buffer += '"';
+            this->AppendEscaped(value);
+            m_buffer += '"';
+        }
+
+        void Integer(long long value)
+        {
+            this->Separate();
+            char digits[24];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            m_buffer.append(digits, result.ptr - digits);
+        }
+
+        void Number(double value)
+        {
+            this->Separate();
+
+            // JSON has no NaN or Infinity, CDP reads null as the parameter being left out.
+            if (!std::isfinite(value))
+            {
+                m_buffer.append("null");
+                return;
+            }
+
+            // shortest round-trip form, and unlike printf never affected by the locale's decimal separator.
+            char digits[32];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            m_buffer.append(digits, result.ptr - digits);
+        }
+
+        void Boolean(bool value)
+        {
+            this->Separate();
+            m_buffer.append(value ? "true" : "false");
+        }
+
+        void Raw(std::string_view json)
+        {
+            this->Separate();
+            m_buffer.append(json);
+        }
+
+        std::string Take() { return std::move(m_buffer); }
+
+    private:
+        static constexpr int MaxDepth = 32;
+
+        std::string m_buffer;
+        int m_depth = 0;
+        bool m_first[MaxDepth] = { true };
+
+        void Push()
+        {
+            if (m_depth + 1 >= MaxDepth)
+            {
+                throw std::length_error("CDP::Writer nested deeper than its limit of " + std::to_string(MaxDepth - 1) + " levels");
+            }
+            m_first[++m_depth] = true;
+        }
+
+        void Separate()
+        {
+            if (!m_first[m_depth])
+            {
+                m_buffer += ',';
+            }
+            m_first[m_depth] = false;
+        }
+
+        void AppendEscaped(std::string_view value)
+        {
+            const char* it = value.data();
+            const char* end = it + value.size();
+
+            while (it < end)
+            {
+                // copy runs of plain characters in one go, base64 bodies never leave this loop.
+                const char* run = it;
+                while (it < end && (unsigned char)*it >= 0x20 && *it != '"' && *it != '\\')
+                {
+                    it++;
+                }
+                m_buffer.append(run, it - run);
+
+                if (it == end)
+                {
+                    break;
+                }
+
+                switch (*it)
+                {
+                    case '"':  m_buffer += "\\\""; break;
+                    case '\\': m_buffer += "\\\\"; break;
+                    case '\n': m_buffer += "\\n";  break;
+                    case '\r': m_buffer += "\\r";  break;
+                    case '\t': m_buffer += "\\t";  break;
+                    case '\b': m_buffer += "\\b";  break;
+                    case '\f': m_buffer += "\\f";  break;
+                    default:
+                    {
+                        static constexpr char hex[] = "0123456789abcdef";
+                        const unsigned char c = *it;
+                        const char escaped[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+                        m_buffer.append(escaped, sizeof(escaped));
+                        break;
+                    }
+                }
+                it++;
+            }
+        }
+    };
+
+    inline void Write(Writer& writer, std::string_view value) { writer.String(value); }
+    inline void Write(Writer& writer, const std::string& value) { writer.String(value); }
+    inline void Write(Writer& writer, long long value) { writer.Integer(value); }
+    inline void Write(Writer& writer, double value) { writer.Number(value); }
+    inline void Write(Writer& writer, bool value) { writer.Boolean(value); }
+    inline void Write(Writer& writer, const RawJson& value) { writer.Raw(value.text); }
+
+    template <typename T>
+    void Write(Writer& writer, const std::vector<T>& values)
+    {
+        writer.BeginArray();
+        for (const auto& value : values)
+        {
+            Write(writer, value);
+        }
+        writer.EndArray();
+    }
+
+    /* reserve hints, they only need to be close. */
+    inline std::size_t EstimateSize(std::string_view value) { return value.size() + 2; }
+    inline std::size_t EstimateSize(const std::string& value) { return value.size() + 2; }
+    inline std::size_t EstimateSize(long long) { return 20; }
+    inline std::size_t EstimateSize(double) { return 24; }
+    inline std::size_t EstimateSize(bool) { return 5; }
+    inline std::size_t EstimateSize(const RawJson& value) { return value.text.size(); }
+
+    template <typename T>
+    std::size_t EstimateSize(const std::optional<T>& value)
+    {
+        return value.has_value() ? EstimateSize(*value) : 0;
+    }
+
+    template <typename T>
+    std::size_t EstimateSize(const std::vector<T>& values)
+    {
+        std::size_t size = 2;
+        for (const auto& value : values)
+        {
+            size += EstimateSize(value) + 1;
+        }
+        return size;
+    }
+}
@@ -7,14 +7,23 @@
 #include <core/loader.h>
 #include <core/hooks/web_load.h>
 #include <core/ffi/ffi.h>
+#include <core/cdp/client.h>
+#include <core/ftp/serv.h>
+#include <sys/file_cache.h>
 #include <tuple>
 
 const std::string GetBootstrapModule(const std::vector<std::string> scriptModules, const uint16_t port)
 {
+    // client_api.js, already followed by the start of the call the script modules are passed to.
+    static SystemIO::CachedFile clientShim(SystemIO::GetInstallPath() / "ext" / "data" / "shims" / "client_api.js", [](std::string source)
+    {
+        return source.empty() ? std::string() : source + "\nmillennium_components(";
+    });
+
     std::string scriptModuleArray;
-    std::string scriptContents = SystemIO::ReadFileSync((SystemIO::GetInstallPath() / "ext" / "data" / "shims" / "client_api.js").string());
+    const auto clientShimPrelude = clientShim.Get();
 
-    if (scriptContents.empty())
+    if (!clientShimPrelude || clientShimPrelude->empty())
     {
         LOG_ERROR("Missing webkit preload module. Please re-install Millennium.");
         #ifdef _WIN32
@@ -27,7 +36,8 @@ const std::string GetBootstrapModule(const std::vector<std::string> scriptModule
         scriptModuleArray.append(fmt::format("\"{}\"{}", scriptModules[i], (i == scriptModules.size() - 1 ? "" : ",")));
     }
 
-    return fmt::format("{}\nmillennium_components({}, [{}]);", scriptContents, port, scriptModuleArray);
+    const std::string prelude = clientShimPrelude && !clientShimPrelude->empty() ? *clientShimPrelude : "\nmillennium_components(";
+    return prelude + fmt::format("{}, [{}]);", port, scriptModuleArray);
 }
 
 /// @brief sets up the python interpreter to use virtual environment site packages, as well as custom python path.
@@ -241,6 +251,18 @@ const std::string ConstructOnLoadModule(uint16_t ftpPort, uint16_t ipcPort)
         scriptImportTable.push_back(fmt::format("http://localhost:{}/{}{}", ftpPort, pathShim, frontEndAbs));
     }
 
+    Crow::SetFrontendBundle(scriptImportTable);
+
+    /**
+     * opt-in: client_api.js is then handed the single /__bundle url instead of one url per plugin, so it only sees
+     * the bundle's import succeed or fail, not each plugin's (see Crow::SetFrontendBundle). in exchange the browser
+     * fetches every frontend in parallel, rather than one after the other.
+     */
+    if (!scriptImportTable.empty() && settingsStore->GetSetting("bundle_frontends", "false") == "true")
+    {
+        return GetBootstrapModule({ fmt::format("http://localhost:{}/__bundle", ftpPort) }, ipcPort);
+    }
+
     return GetBootstrapModule(scriptImportTable, ipcPort);
 }
 
@@ -257,14 +279,6 @@ void OnBackendLoad(uint16_t ftpPort, uint16_t ipcPort)
     static uint16_t m_ftpPort = ftpPort;
     static uint16_t m_ipcPort = ipcPort;
 
-    enum PageMessage
-    {
-        DEBUGGER_RESUME = 1,
-        PAGE_ENABLE = 2,
-        PAGE_SCRIPT = 3,
-        PAGE_RELOAD = 4
-    };
-
     std::mutex mtx;
     std::condition_variable cvDebugger;
     std::condition_variable cvScript;
@@ -272,57 +286,39 @@ void OnBackendLoad(uint16_t ftpPort, uint16_t ipcPort)
     bool hasUnpausedDebugger = false;
     bool hasScriptIdentifier = false;
 
-    auto socketEmitterThread = std::thread([&]
+    CDP::Client& client = CDP::Client::InstanceRef();
+
+    const auto OnScriptInjected = [&](const CDP::Message& eventMessage)
     {
-        JavaScript::SharedJSMessageEmitter::InstanceRef().OnMessage("msg", "OnBackendLoad", [&](const nlohmann::json& eventMessage, std::string listenerId)
+        std::unique_lock<std::mutex> lock(mtx);
+
+        addedScriptOnNewDocumentId = eventMessage.Json()["result"]["identifier"];
+        hasScriptIdentifier = true;
+        Logger.Log("Successfully injected shims, updating state...");
+        client.SendShared(CDP::Page::Reload {});
+        cvScript.notify_one();  // Notify that script injection is processed
+    };
+
+    const auto OnDebuggerResumed = [&](const CDP::Message& eventMessage)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+
+        if (eventMessage.HasError())
         {
-            std::unique_lock<std::mutex> lock(mtx);
-            
-            try
-            {
-                const int messageId = eventMessage.value("id", -1);
-
-                if (messageId == DEBUGGER_RESUME)
-                {
-                    if (eventMessage.contains("error"))
-                    {
-                        hasUnpausedDebugger = false;
-                        Logger.Warn("Failed to resume debugger, Steam is likely not yet loaded...");
-                    }
-                    else if (eventMessage.contains("result"))
-                    {
-                        hasUnpausedDebugger = true;
-                        Logger.Log("Successfully resumed debugger, injecting shims...");
-                        Sockets::PostShared({ {"id", PAGE_ENABLE }, {"method", "Page.enable"} });
-                        Sockets::PostShared({ {"id", PAGE_SCRIPT }, {"method", "Page.addScriptToEvaluateOnNewDocument"}, {"params", {{ "source", ConstructOnLoadModule(m_ftpPort, m_ipcPort) }}} });
-                    }
-                    cvDebugger.notify_one();  // Notify that debugger resume is processed
-                }
-                else if (messageId == PAGE_SCRIPT)
-                {
-                    addedScriptOnNewDocumentId = eventMessage["result"]["identifier"];
-                    hasScriptIdentifier = true;
-                    Logger.Log("Successfully injected shims, updating state...");
-                    Sockets::PostShared({ {"id", PAGE_RELOAD }, {"method", "Page.reload"} });
-                    cvScript.notify_one();  // Notify that script injection is processed
-                }
-
-                // Check if both conditions have been met
-                if (hasUnpausedDebugger && hasScriptIdentifier)
-                {
-                    Logger.Log("Successfully notified frontend...");
-                    JavaScript::SharedJSMessageEmitter::InstanceRef().RemoveListener("msg", listenerId);
-                }
-            }
-            catch (nlohmann::detail::exception& ex)
-            {
-                LOG_ERROR("JavaScript::SharedJSMessageEmitter error -> {}", ex.what());
-            }
-        });
-    });
+            hasUnpausedDebugger = false;
+            Logger.Warn("Failed to resume debugger, Steam is likely not yet loaded...");
+        }
+        else
+        {
+            hasUnpausedDebugger = true;
+            Logger.Log("Successfully resumed debugger, injecting shims...");
+            client.SendShared(CDP::Page::Enable {});
+            client.SendShared(CDP::Page::AddScriptToEvaluateOnNewDocument { ConstructOnLoadModule(m_ftpPort, m_ipcPort) }, OnScriptInjected);
+        }
+        cvDebugger.notify_one();  // Notify that debugger resume is processed
+    };
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    Sockets::PostShared({ {"id", DEBUGGER_RESUME }, {"method", "Debugger.resume"} });
+    client.SendShared(CDP::Debugger::Resume {}, OnDebuggerResumed);
 
     // Wait for debugger resume
     {
@@ -336,8 +332,7 @@ void OnBackendLoad(uint16_t ftpPort, uint16_t ipcPort)
         cvScript.wait(lock, [&] { return hasScriptIdentifier; });
     }
 
-    socketEmitterThread.join();
-    Logger.Log("Frontend notifier finished!");
+    Logger.Log("Successfully notified frontend...");
 }
 
 const void CoInitializer::InjectFrontendShims(uint16_t ftpPort, uint16_t ipcPort) 
@@ -348,45 +343,35 @@ const void CoInitializer::InjectFrontendShims(uint16_t ftpPort, uint16_t ipcPort
 
     Logger.Log("Preparing to inject frontend shims...");
 
-    JavaScript::SharedJSMessageEmitter::InstanceRef().OnMessage("msg", "InjectFrontendShims", [&](const nlohmann::json& eventMessage, std::string listenerId) 
+    CDP::Client& client = CDP::Client::InstanceRef();
+
+    const unsigned long long pausedSubscriberId = client.Subscribe(CDP::Method::Debugger_paused, [&](const CDP::Message& eventMessage) 
     {
         std::lock_guard<std::mutex> lock(mtx);
-        
-        if (eventMessage.value("id", -1) == 65756) 
-        {
-            if (eventMessage.contains("error")) 
-            {
-                Logger.Warn("Failed to pause debugger, Steam is likely not yet loaded...");
-                Sockets::PostShared({ {"id", 65756 }, {"method", "Debugger.pause"} });
-            } 
-            else if (eventMessage.contains("result")) 
-            {
-                Logger.Log("Successfully sent debugger pause...");
-                hasSuccess = true;
-            }
-        }
-        if (eventMessage.contains("method") && eventMessage["method"] == "Debugger.paused") 
-        {
-            Logger.Log("Debugger has paused!");
-            hasPaused = true;
-        }
+        Logger.Log("Debugger has paused!");
+        hasPaused = true;
+        cv.notify_all(); 
+    });
 
-        if (hasSuccess && hasPaused) 
+    CDP::ResponseHandler OnDebuggerPause = [&](const CDP::Message& eventMessage) 
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        if (eventMessage.HasError()) 
+        {
+            Logger.Warn("Failed to pause debugger, Steam is likely not yet loaded...");
+            client.SendShared(CDP::Debugger::Pause {}, OnDebuggerPause);
+        } 
+        else 
         {
-            try 
-            {
-                JavaScript::SharedJSMessageEmitter::InstanceRef().RemoveListener("msg", listenerId);
-            } 
-            catch (const std::exception& ex) 
-            {
-                LOG_ERROR("Error removing listener: {}", ex.what());
-            }
+            Logger.Log("Successfully sent debugger pause...");
+            hasSuccess = true;
             cv.notify_all(); 
         }
-    });
+    };
 
-    Sockets::PostShared({ {"id", 3422 }, {"method", "Debugger.enable"} });
-    Sockets::PostShared({ {"id", 65756 }, {"method", "Debugger.pause"} });
+    client.SendShared(CDP::Debugger::Enable {});
+    client.SendShared(CDP::Debugger::Pause {}, OnDebuggerPause);
 
     try 
     {
@@ -396,9 +381,12 @@ const void CoInitializer::InjectFrontendShims(uint16_t ftpPort, uint16_t ipcPort
     catch (const std::system_error& e)
     {
         LOG_ERROR("Condition variable wait error: {}", e.what());
+        client.Unsubscribe(CDP::Method::Debugger_paused, pausedSubscriberId);
         return;
     }
 
+    client.Unsubscribe(CDP::Method::Debugger_paused, pausedSubscriberId);
+
     Logger.Log("Ready to inject shims!");
     BackendCallbacks& backendHandler = BackendCallbacks::getInstance();
     backendHandler.RegisterForLoad(std::bind(OnBackendLoad, ftpPort, ipcPort));
@@ -406,6 +394,6 @@ const void CoInitializer::InjectFrontendShims(uint16_t ftpPort, uint16_t ipcPort
 
 const void CoInitializer::ReInjectFrontendShims()
 {
-    Sockets::PostShared({ {"id", 0 }, {"method", "Page.removeScriptToEvaluateOnNewDocument"}, {"params", {{ "identifier", addedScriptOnNewDocumentId }}} });
+    CDP::Client::InstanceRef().SendShared(CDP::Page::RemoveScriptToEvaluateOnNewDocument { addedScriptOnNewDocumentId });
     InjectFrontendShims();
-}
+}
\ No newline at end of file
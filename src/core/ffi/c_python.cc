@@ -2,38 +2,184 @@
 #include <core/py_controller/co_spawn.h>
 #include <iostream>
 #include <tuple>
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <sys/encoding.h>
 
-std::string Python::ConstructFunctionCall(nlohmann::basic_json<> data)
+PyObject* Python::FromJson(const nlohmann::json& value)
 {
-    std::string strFunctionCall = data["methodName"];
-    strFunctionCall += "(";
+    switch (value.type())
+    {
+        case nlohmann::json::value_t::boolean:         return PyBool_FromLong(value.get<bool>());
+        case nlohmann::json::value_t::number_integer:  return PyLong_FromLongLong(value.get<long long>());
+        case nlohmann::json::value_t::number_unsigned: return PyLong_FromUnsignedLongLong(value.get<unsigned long long>());
+        case nlohmann::json::value_t::number_float:    return PyFloat_FromDouble(value.get<double>());
+        case nlohmann::json::value_t::string:
+        {
+            const auto& string = value.get_ref<const std::string&>();
+            return PyUnicode_FromStringAndSize(string.data(), string.size());
+        }
+        case nlohmann::json::value_t::binary:
+        {
+            const auto& binary = value.get_binary();
+            return PyBytes_FromStringAndSize(reinterpret_cast<const char*>(binary.data()), binary.size());
+        }
+        case nlohmann::json::value_t::array:
+        {
+            PyObject* list = PyList_New(value.size());
+            Py_ssize_t index = 0;
+
+            for (auto it = value.begin(); list && it != value.end(); ++it, ++index)
+            {
+                PyObject* item = Python::FromJson(*it);
+
+                if (!item)
+                {
+                    Py_CLEAR(list);
+                    break;
+                }
+                PyList_SET_ITEM(list, index, item); // steals item
+            }
+            return list;
+        }
+        case nlohmann::json::value_t::object:
+        {
+            PyObject* dict = PyDict_New();
+
+            for (auto it = value.begin(); dict && it != value.end(); ++it)
+            {
+                PyObject* key = PyUnicode_FromStringAndSize(it.key().data(), it.key().size());
+                PyObject* item = key ? Python::FromJson(it.value()) : nullptr;
+
+                if (!item || PyDict_SetItem(dict, key, item) != 0)
+                {
+                    Py_CLEAR(dict);
+                }
+                Py_XDECREF(key);
+                Py_XDECREF(item);
+            }
+            return dict;
+        }
+        default: Py_RETURN_NONE;
+    }
+}
+
+/* deep enough for any real payload, shallow enough to catch self-referencing containers. */
+static constexpr int MaxJsonDepth = 256;
+
+static std::string TakeExceptionMessage()
+{
+    const auto [errorMessage, traceback] = Python::GetExceptionInformaton();
+    return errorMessage;
+}
 
-    if (data.contains("argumentList"))
+static nlohmann::json ToJson(PyObject* object, int depth)
+{
+    if (depth > MaxJsonDepth)
+    {
+        throw std::runtime_error(fmt::format("object is nested deeper than {} levels, is it self-referencing?", MaxJsonDepth));
+    }
+
+    if (object == Py_None)
+    {
+        return nullptr;
+    }
+    if (PyBool_Check(object))
+    {
+        return object == Py_True;
+    }
+    if (PyLong_Check(object))
+    {
+        int overflow = 0;
+        const long long value = PyLong_AsLongLongAndOverflow(object, &overflow);
+
+        if (overflow == 0)
+        {
+            return value;
+        }
+
+        const unsigned long long unsignedValue = overflow > 0 ? PyLong_AsUnsignedLongLong(object) : 0;
+
+        if (overflow > 0 && !PyErr_Occurred())
+        {
+            return unsignedValue;
+        }
+        PyErr_Clear();
+        return PyLong_AsDouble(object); // past 64 bits, a double is what JSON.parse would make of it anyway
+    }
+    if (PyFloat_Check(object))
     {
-        int index = 0, argumentLength = data["argumentList"].size();
+        return PyFloat_AS_DOUBLE(object);
+    }
+    if (PyUnicode_Check(object))
+    {
+        Py_ssize_t size = 0;
+        const char* utf8 = PyUnicode_AsUTF8AndSize(object, &size);
 
-        for (auto argIterator = data["argumentList"].begin(); argIterator != data["argumentList"].end(); ++argIterator, ++index)
+        if (!utf8)
         {
-            auto& parameterKeyWord = argIterator.key();
-            auto& parameterData = argIterator.value();
+            throw std::runtime_error(TakeExceptionMessage());
+        }
+        return std::string(utf8, size);
+    }
+    if (PyBytes_Check(object) || PyByteArray_Check(object))
+    {
+        // JSON has no binary type, bytes travel base64 encoded like plain string returns do.
+        const bool isBytes = PyBytes_Check(object);
+        const char* data = isBytes ? PyBytes_AS_STRING(object) : PyByteArray_AS_STRING(object);
+        const Py_ssize_t size = isBytes ? PyBytes_GET_SIZE(object) : PyByteArray_GET_SIZE(object);
+
+        return Base64Encode(std::string_view(data, size));
+    }
+    if (PyDict_Check(object))
+    {
+        nlohmann::json result = nlohmann::json::object();
+        PyObject* key = nullptr;
+        PyObject* value = nullptr;
+        Py_ssize_t position = 0;
 
-            if (parameterData.is_boolean()) 
-            { 
-                strFunctionCall += fmt::format("{}={}", parameterKeyWord, parameterData ? "True" : "False"); 
+        while (PyDict_Next(object, &position, &key, &value))
+        {
+            if (PyUnicode_Check(key))
+            {
+                result[ToJson(key, depth + 1).get<std::string>()] = ToJson(value, depth + 1);
+            }
+            else if (PyLong_Check(key) && !PyBool_Check(key))
+            {
+                result[ToJson(key, depth + 1).dump()] = ToJson(value, depth + 1); // as json.dumps does
             }
-            else 
-            { 
-                strFunctionCall += fmt::format("{}={}", parameterKeyWord, parameterData.dump()); 
+            else
+            {
+                throw std::runtime_error(fmt::format("keys must be str or int, not {}", Py_TYPE(key)->tp_name));
             }
+        }
+        return result;
+    }
+    if (PyList_Check(object) || PyTuple_Check(object))
+    {
+        const bool isList = PyList_Check(object);
+        const Py_ssize_t size = isList ? PyList_GET_SIZE(object) : PyTuple_GET_SIZE(object);
+        nlohmann::json result = nlohmann::json::array();
 
-            if (index < argumentLength - 1)
+        for (Py_ssize_t index = 0; index < size; ++index)
+        {
+            // a list can shrink under us if an element's conversion runs python code, so re-check its size.
+            if (isList && index >= PyList_GET_SIZE(object))
             {
-                strFunctionCall += ", ";
+                break;
             }
+            result.push_back(ToJson(isList ? PyList_GET_ITEM(object, index) : PyTuple_GET_ITEM(object, index), depth + 1));
         }
+        return result;
     }
-    strFunctionCall += ")";
-    return strFunctionCall;
+
+    throw std::runtime_error(fmt::format("Millennium can't convert [{}] to JSON, expected one of [dict, list, tuple, str, int, float, bool, bytes, None]", Py_TYPE(object)->tp_name));
+}
+
+nlohmann::json Python::ToJson(PyObject* object)
+{
+    return ::ToJson(object, 0);
 }
 
 std::tuple<std::string, std::string> Python::GetExceptionInformaton() 
@@ -87,6 +233,44 @@ std::tuple<std::string, std::string> Python::GetExceptionInformaton()
     return { errorMessage, tracebackText };
 }
 
+static bool FitsInInt(PyObject* longObj)
+{
+    int overflow = 0;
+    const long long value = PyLong_AsLongLongAndOverflow(longObj, &overflow);
+    return overflow == 0 && value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max();
+}
+
+static Python::EvalResult ToEvalResult(PyObject* EvaluatedObj)
+{
+    if (EvaluatedObj == nullptr || EvaluatedObj == Py_None) 
+    {
+        return { "0", Python::Types::Integer }; // whitelist NoneType
+    }
+    if (PyBool_Check(EvaluatedObj)) 
+    {
+        return { PyLong_AsLong(EvaluatedObj) == 0 ? "False" : "True", Python::Types::Boolean };
+    }
+    else if (PyLong_Check(EvaluatedObj) && FitsInInt(EvaluatedObj)) 
+    {
+        return { std::to_string(PyLong_AsLong(EvaluatedObj)), Python::Types::Integer };
+    }
+    else if (PyUnicode_Check(EvaluatedObj)) 
+    {
+        return { PyUnicode_AsUTF8(EvaluatedObj), Python::Types::String };
+    }
+
+    // everything else goes back as JSON, i.e dicts, lists, floats and ints too wide for the frontend's int parsing.
+    try
+    {
+        return { std::string(), Python::Types::Unknown, Python::ToJson(EvaluatedObj) };
+    }
+    catch (const std::runtime_error& ex)
+    {
+        PyErr_Clear();
+        return { ex.what(), Python::Types::Error };
+    }
+}
+
 const Python::EvalResult EvaluatePython(std::string pluginName, std::string script) 
 {
     PyObject* globalDictionaryObj = PyModule_GetDict(PyImport_AddModule("__main__"));
@@ -99,31 +283,227 @@ const Python::EvalResult EvaluatePython(std::string pluginName, std::string scri
         Logger.PrintMessage(" FFI-ERROR ", fmt::format("Failed to call {}: {}\n{}{}", script, COL_RED, traceback, COL_RESET), COL_RED);
     }
 
-    if (EvaluatedObj == nullptr || EvaluatedObj == Py_None) 
+    Python::EvalResult result = ToEvalResult(EvaluatedObj);
+    Py_XDECREF(EvaluatedObj);
+    return result;
+}
+
+/**
+ * Resolves a dotted method name (i.e "Backend.receive_frontend_message") against the interpreter's __main__.
+ * Lookups are cached in the interpreter's own state dict, so they're freed along with the interpreter. An entry
+ * holds on to the global it was resolved from and is dropped once that global is rebound.
+ *
+ * @return a new reference to the callable, or nullptr with a python exception set.
+ */
+static PyObject* ResolveMethod(const std::string& methodName)
+{
+    PyObject* interpreterDict = PyInterpreterState_GetDict(PyInterpreterState_Get());
+    PyObject* methodCache = interpreterDict ? PyDict_GetItemString(interpreterDict, "millennium.method_cache") : nullptr;
+
+    if (interpreterDict && !methodCache)
     {
-        return { "0", Python::Types::Integer }; // whitelist NoneType
+        methodCache = PyDict_New();
+
+        if (!methodCache || PyDict_SetItemString(interpreterDict, "millennium.method_cache", methodCache) != 0)
+        {
+            Py_XDECREF(methodCache);
+            return nullptr;
+        }
+        Py_DECREF(methodCache); // borrowed from the interpreter dict from here on
     }
-    if (PyBool_Check(EvaluatedObj)) 
+
+    const std::string rootName = methodName.substr(0, methodName.find('.'));
+    PyObject* globalDictionaryObj = PyModule_GetDict(PyImport_AddModule("__main__"));
+    PyObject* rootObj = PyDict_GetItemString(globalDictionaryObj, rootName.c_str());
+
+    if (!rootObj)
     {
-        return { PyLong_AsLong(EvaluatedObj) == 0 ? "False" : "True", Python::Types::Boolean };
+        PyErr_Format(PyExc_NameError, "name '%s' is not defined", rootName.c_str());
+        return nullptr;
     }
-    else if (PyLong_Check(EvaluatedObj)) 
+
+    PyObject* cachedEntry = methodCache ? PyDict_GetItemString(methodCache, methodName.c_str()) : nullptr;
+
+    if (cachedEntry && PyTuple_GET_ITEM(cachedEntry, 0) == rootObj)
     {
-        return { std::to_string(PyLong_AsLong(EvaluatedObj)), Python::Types::Integer };
+        PyObject* callable = PyTuple_GET_ITEM(cachedEntry, 1);
+        Py_INCREF(callable);
+        return callable;
     }
-    else if (PyUnicode_Check(EvaluatedObj)) 
+
+    PyObject* callable = rootObj;
+    Py_INCREF(callable);
+
+    for (std::size_t begin = rootName.size(); callable && begin < methodName.size(); )
     {
-        return { PyUnicode_AsUTF8(EvaluatedObj), Python::Types::String };
+        const std::size_t end = std::min(methodName.find('.', begin + 1), methodName.size());
+        const std::string attributeName = methodName.substr(begin + 1, end - begin - 1);
+
+        PyObject* attributeObj = PyObject_GetAttrString(callable, attributeName.c_str());
+        Py_DECREF(callable);
+        callable = attributeObj;
+        begin = end;
     }
 
-    PyObject* objectType = PyObject_Type(EvaluatedObj);
-    PyObject* strObjectType = PyObject_Str(objectType);
-    const char* strTypeName = PyUnicode_AsUTF8(strObjectType);
-    PyErr_Clear();  // Clear any Python exception
-    Py_XDECREF(objectType);
-    Py_XDECREF(strObjectType);
+    if (callable && !PyCallable_Check(callable))
+    {
+        PyErr_Format(PyExc_TypeError, "'%s' is not callable", methodName.c_str());
+        Py_CLEAR(callable);
+    }
+
+    if (callable && methodCache)
+    {
+        PyObject* entry = PyTuple_Pack(2, rootObj, callable);
 
-    return { fmt::format("Millennium expected return type [int, str, bool] but received [{}]", strTypeName) , Python::Types::Error };
+        if (!entry || PyDict_SetItemString(methodCache, methodName.c_str(), entry) != 0)
+        {
+            PyErr_Clear(); // the call itself can still go ahead uncached
+        }
+        Py_XDECREF(entry);
+    }
+    return callable;
+}
+
+static Python::EvalResult InvokePythonMethod(std::string pluginName, const std::string& methodName, const nlohmann::json& argumentList)
+{
+    PyObject* callable = ResolveMethod(methodName);
+    PyObject* keywordArgs = nullptr;
+    PyObject* EvaluatedObj = nullptr;
+
+    if (callable && !argumentList.empty())
+    {
+        keywordArgs = Python::FromJson(argumentList);
+    }
+
+    if (callable && !PyErr_Occurred())
+    {
+        EvaluatedObj = PyObject_VectorcallDict(callable, nullptr, 0, keywordArgs);
+    }
+
+    if (!EvaluatedObj && PyErr_Occurred()) 
+    {
+        const auto [errorMessage, traceback] = Python::GetExceptionInformaton();
+
+        Logger.PrintMessage(" FFI-ERROR ", fmt::format("Failed to call {} on {}: {}\n{}{}", methodName, pluginName, COL_RED, 
+            traceback.empty() ? errorMessage : traceback, COL_RESET), COL_RED);
+    }
+
+    Python::EvalResult result = ToEvalResult(EvaluatedObj);
+    Py_XDECREF(EvaluatedObj);
+    Py_XDECREF(keywordArgs);
+    Py_XDECREF(callable);
+    return result;
+}
+
+/**
+ * Runs `fn` inside the plugin's interpreter. Once the plugin has loaded that's on its own thread, in the order calls
+ * were made. Before then (plugins are free to never return from _load) the calling thread enters the interpreter itself.
+ */
+template <typename Fn>
+static std::invoke_result_t<Fn> RunInInterpreter(const std::string& pluginName, PyThreadState* threadState, Fn fn, std::invoke_result_t<Fn> refused)
+{
+    PythonManager& manager = PythonManager::GetInstance();
+
+    if (manager.IsExecuting(pluginName))
+    {
+        try
+        {
+            return manager.Submit(pluginName, std::move(fn)).get();
+        }
+        catch (const std::runtime_error& ex)
+        {
+            LOG_ERROR("couldn't run on plugin [{}] -> {}", pluginName, ex.what());
+            return refused;
+        }
+    }
+
+    InterpreterLock interpreterLock(threadState);
+
+    if (!interpreterLock) 
+    {
+        LOG_ERROR("plugin [{}] is shutting down, refusing to call into it.", pluginName);
+        return refused;
+    }
+    return fn();
+}
+
+/**
+ * Queues `fn` on the plugin's own thread without waiting for it, `then` is handed its result there with the GIL released.
+ * Unlike RunInInterpreter nothing blocks on the plugin, so a call it makes into the frontend can be called back into.
+ */
+template <typename Fn, typename Then>
+static bool PostToInterpreter(const std::string& pluginName, Fn fn, Then then)
+{
+    return PythonManager::GetInstance().Post(pluginName, [pluginName, fn = std::move(fn), then = std::move(then)]() mutable
+    {
+        std::optional<std::invoke_result_t<Fn>> result;
+
+        try
+        {
+            result.emplace(fn());
+        }
+        catch (const std::exception& ex)
+        {
+            LOG_ERROR("uncaught error running a call on plugin [{}] -> {}", pluginName, ex.what());
+            return;
+        }
+
+        // nothing may escape the block, the executor expects the GIL back when the task returns.
+        Py_BEGIN_ALLOW_THREADS
+        try
+        {
+            then(std::move(*result));
+        }
+        catch (const std::exception& ex)
+        {
+            LOG_ERROR("uncaught error handing a result back from plugin [{}] -> {}", pluginName, ex.what());
+        }
+        catch (...)
+        {
+            LOG_ERROR("uncaught error handing a result back from plugin [{}]", pluginName);
+        }
+        Py_END_ALLOW_THREADS
+    });
+}
+
+static nlohmann::json GetArgumentList(const nlohmann::json& functionCall)
+{
+    return functionCall.contains("argumentList") && !functionCall["argumentList"].is_null() ? functionCall["argumentList"] : nlohmann::json::object();
+}
+
+/* arguments are passed by keyword, anything but an object of them can't be mapped onto the call. */
+static std::optional<Python::EvalResult> RefuseArgumentList(const std::string& pluginName, const std::string& methodName, const nlohmann::json& argumentList)
+{
+    if (argumentList.is_object())
+    {
+        return std::nullopt;
+    }
+
+    LOG_ERROR("refusing to call {} on plugin [{}], argumentList must be an object but is {}", methodName, pluginName, argumentList.type_name());
+    return Python::EvalResult { fmt::format("argumentList must be an object of keyword arguments, got {}", argumentList.type_name()), Python::Error };
+}
+
+static bool DiscardEvaluatePython(const std::string& pluginName, const std::string& script)
+{
+    PyObject* globalDictionaryObj = PyModule_GetDict(PyImport_AddModule("__main__"));
+    PyObject* EvaluatedObj = PyRun_String(script.c_str(), Py_eval_input, globalDictionaryObj, globalDictionaryObj);
+
+    if (!EvaluatedObj && PyErr_Occurred()) 
+    {
+        const auto [errorMessage, traceback] = Python::GetExceptionInformaton();
+        PyErr_Clear();
+
+        if (errorMessage == "name 'plugin' is not defined")
+        {
+            Logger.PrintMessage(" FFI-ERROR ", fmt::format("Millennium failed to call {} on {} as the function "
+                "does not exist, or the interpreter crashed before it was loaded.", script, pluginName), COL_RED);
+            return false;
+        }
+
+        Logger.PrintMessage(" FFI-ERROR ", fmt::format("Millennium failed to call {} on {}: {}\n{}{}", script, pluginName, COL_RED, traceback, COL_RESET), COL_RED);
+    }
+    Py_XDECREF(EvaluatedObj);
+    return EvaluatedObj != nullptr;
 }
 
 Python::EvalResult Python::LockGILAndEvaluate(std::string pluginName, std::string script)
@@ -136,19 +516,32 @@ Python::EvalResult Python::LockGILAndEvaluate(std::string pluginName, std::strin
         return { "overstepped partying thread state", Error };
     }
 
-    std::shared_ptr<PythonGIL> pythonGilLock = std::make_shared<PythonGIL>();
-    pythonGilLock->HoldAndLockGILOnThread(threadState);
+    return RunInInterpreter(pluginName, threadState, [&]() -> Python::EvalResult { return EvaluatePython(pluginName, script); }, { "plugin is shutting down", Error });
+}
+
+Python::EvalResult Python::LockGILAndInvokeMethod(std::string pluginName, const nlohmann::json& functionCall)
+{
+    const std::string methodName = functionCall.value("methodName", std::string());
+    const nlohmann::json argumentList = GetArgumentList(functionCall);
 
-    if (threadState == NULL) 
+    if (auto refused = RefuseArgumentList(pluginName, methodName, argumentList))
     {
-        LOG_ERROR("script execution was queried but the receiving parties thread state was nullptr");
-        return { "thread state was nullptr", Error };
+        return *refused;
     }
 
-    Python::EvalResult response = EvaluatePython(pluginName, script);
+    auto [strPluginName, threadState, interpMutex] = PythonManager::GetInstance().GetPythonThreadStateFromName(pluginName);
+
+    if (threadState == nullptr) 
+    {
+        LOG_ERROR(fmt::format("couldn't get thread state ptr from plugin [{}], maybe it crashed or exited early? Tried to call -> {}", pluginName, methodName));
+        return { "overstepped partying thread state", Error };
+    }
 
-    pythonGilLock->ReleaseAndUnLockGIL();
-    return response;
+    return RunInInterpreter(pluginName, threadState, [&] 
+    { 
+        return InvokePythonMethod(pluginName, methodName, argumentList); 
+    }, 
+    { "plugin is shutting down", Error });
 }
 
 void Python::LockGILAndDiscardEvaluate(std::string pluginName, std::string script)
@@ -161,26 +554,28 @@ void Python::LockGILAndDiscardEvaluate(std::string pluginName, std::string scrip
         return;
     }
 
-    std::shared_ptr<PythonGIL> pythonGilLock = std::make_shared<PythonGIL>();
-    pythonGilLock->HoldAndLockGILOnThread(threadState);
-    {
-        PyObject* globalDictionaryObj = PyModule_GetDict(PyImport_AddModule("__main__"));
-        PyObject* EvaluatedObj = PyRun_String(script.c_str(), Py_eval_input, globalDictionaryObj, globalDictionaryObj);
-
-        if (!EvaluatedObj && PyErr_Occurred()) 
-        {
-            const auto [errorMessage, traceback] = Python::GetExceptionInformaton();
-            PyErr_Clear();
+    RunInInterpreter(pluginName, threadState, [&] { return DiscardEvaluatePython(pluginName, script); }, false);
+}
 
-            if (errorMessage == "name 'plugin' is not defined")
-            {
-                Logger.PrintMessage(" FFI-ERROR ", fmt::format("Millennium failed to call {} on {} as the function "
-                    "does not exist, or the interpreter crashed before it was loaded.", script, pluginName), COL_RED);
-                return;
-            }
+bool Python::InvokeMethodAsync(std::string pluginName, nlohmann::json functionCall, std::function<void(EvalResult)> onResult)
+{
+    const std::string methodName = functionCall.value("methodName", std::string());
+    nlohmann::json argumentList = GetArgumentList(functionCall);
 
-            Logger.PrintMessage(" FFI-ERROR ", fmt::format("Millennium failed to call {} on {}: {}\n{}{}", script, pluginName, COL_RED, traceback, COL_RESET), COL_RED);
-        }
+    if (auto refused = RefuseArgumentList(pluginName, methodName, argumentList))
+    {
+        onResult(std::move(*refused));
+        return true;
     }
-    pythonGilLock->ReleaseAndUnLockGIL();
+
+    return PostToInterpreter(pluginName, [pluginName, methodName, argumentList = std::move(argumentList)] 
+    { 
+        return InvokePythonMethod(pluginName, methodName, argumentList); 
+    }, 
+    std::move(onResult));
+}
+
+bool Python::DiscardEvaluateAsync(std::string pluginName, std::string script, std::function<void()> onDone)
+{
+    return PostToInterpreter(pluginName, [pluginName, script] { return DiscardEvaluatePython(pluginName, script); }, [onDone = std::move(onDone)](bool) { onDone(); });
 }
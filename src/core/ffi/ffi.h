@@ -5,6 +5,9 @@
 #include <fmt/core.h>
 #include <sys/log.h>
 #include <thread>
+#include <chrono>
+#include <memory>
+#include <functional>
 
 class PythonGIL : public std::enable_shared_from_this<PythonGIL>
 {
@@ -22,6 +25,36 @@ public:
     ~PythonGIL();
 };
 
+/**
+ * Holds the GIL inside a plugin's sub-interpreter for the lifetime of the lock. Thread states are cached per
+ * (OS thread, interpreter), so entering an interpreter is a GIL acquire rather than a PyThreadState_New/Delete pair
+ * per FFI call. They're freed when their thread exits, or by Purge() before the interpreter ends.
+ */
+class InterpreterLock
+{
+public:
+    struct CachedThreadState;
+
+    /// @param interpreterThreadState any thread state of the interpreter to enter, i.e the one it was created with.
+    explicit InterpreterLock(PyThreadState* interpreterThreadState);
+    ~InterpreterLock();
+
+    InterpreterLock(const InterpreterLock&) = delete;
+    InterpreterLock& operator=(const InterpreterLock&) = delete;
+
+    /// @return false if the interpreter is shutting down, the GIL isn't held in that case.
+    explicit operator bool() const { return m_cachedState != nullptr; }
+
+    /**
+     * @brief free every cached thread state of an interpreter about to be ended, Py_EndInterpreter refuses to run while
+     * other thread states exist. Call it holding the GIL on the interpreter, callers still in flight are let through first.
+     */
+    static void Purge(PyInterpreterState* interpreter);
+
+private:
+    std::shared_ptr<CachedThreadState> m_cachedState;
+};
+
 namespace Python {
 
 	enum Types {
@@ -35,13 +68,30 @@ namespace Python {
 	struct EvalResult {
 		std::string plain;
 		Types type;
+		nlohmann::json json; // the value of an Unknown result
 	};
 
-	std::string ConstructFunctionCall(nlohmann::basic_json<> data);
+    /// @return a new reference to the python equivalent of the value, or nullptr with a python exception set.
+	PyObject* FromJson(const nlohmann::json& value);
+    /// @throws std::runtime_error if the object (or anything nested in it) has no JSON equivalent.
+	nlohmann::json ToJson(PyObject* object);
     std::tuple<std::string, std::string> GetExceptionInformaton();
 
 	EvalResult LockGILAndEvaluate(std::string pluginName, std::string script);
+    /// @brief call functionCall["methodName"] in the plugin's backend with functionCall["argumentList"] as its keyword arguments.
+	EvalResult LockGILAndInvokeMethod(std::string pluginName, const nlohmann::json& functionCall);
 	void LockGILAndDiscardEvaluate(std::string pluginName, std::string script);
+
+    /**
+     * @brief queue a call on the plugin's own thread without waiting for it, for callers that can't block (i.e the IPC
+     * server). `onResult` runs on that thread with the GIL released once the call returns, or right away on the calling
+     * thread if the call is refused outright.
+     *
+     * @return false if the plugin's thread isn't taking calls (still in _load, or shutting down), nothing is queued then.
+     */
+	bool InvokeMethodAsync(std::string pluginName, nlohmann::json functionCall, std::function<void(EvalResult)> onResult);
+    /// @brief like InvokeMethodAsync, for LockGILAndDiscardEvaluate.
+	bool DiscardEvaluateAsync(std::string pluginName, std::string script, std::function<void()> onDone);
 }
 
 namespace JavaScript {
@@ -63,70 +113,16 @@ namespace JavaScript {
         bool successfulCall;
     };
 
-    using EventHandler = std::function<void(const nlohmann::json& eventMessage, std::string listenerId)>;
-
-    class SharedJSMessageEmitter {
-    private:
-        SharedJSMessageEmitter() {}
-
-        std::unordered_map<std::string, std::vector<std::pair<std::string, EventHandler>>> events;
-        std::unordered_map<std::string, std::vector<nlohmann::json>> missedMessages; // New data structure for missed messages
-
+    class TimeoutException : public std::runtime_error {
     public:
-        SharedJSMessageEmitter(const SharedJSMessageEmitter&) = delete;
-        SharedJSMessageEmitter& operator=(const SharedJSMessageEmitter&) = delete;
-
-        static SharedJSMessageEmitter& InstanceRef() {
-            static SharedJSMessageEmitter InstanceRef;
-            return InstanceRef;
-        }
-
-        std::string OnMessage(const std::string& event, const std::string name, EventHandler handler) {
-            events[event].push_back(std::make_pair(name, handler));
-
-            // Deliver any missed messages
-            auto it = missedMessages.find(event);
-            if (it != missedMessages.end()) {
-                for (const auto message : it->second) {
-                    handler(message, name);
-                }
-                missedMessages.erase(it); // Clear missed messages once delivered
-            }
-            return name;
-        }
-
-        void RemoveListener(const std::string& event, std::string listenerId) {
-            auto it = events.find(event);
-            if (it != events.end()) {
-                auto& handlers = it->second;
-                handlers.erase(std::remove_if(handlers.begin(), handlers.end(), [listenerId](const auto& handler) {
-                    if (handler.first == listenerId) {
-                        return true;
-                    }
-                    return false;
-                }), handlers.end());
-            }
-        }
-
-        void EmitMessage(const std::string& event, const nlohmann::json& data) {
-            auto it = events.find(event);
-            if (it != events.end()) {
-                const auto& handlers = it->second;
-                for (const auto& handler : handlers) {
-                    try {
-                        handler.second(data, handler.first);
-                    } catch (const std::bad_function_call& e) {
-                        Logger.Warn("Failed to emit message on {}. exception: {}", handler.first, e.what());
-                    }
-                }
-            } else {
-                missedMessages[event].push_back(data);
-            }
-        }
+        TimeoutException(const std::string& message) : std::runtime_error(message) {}
     };
 
+    // deadline for a single evaluation on SharedJSContext, the expression is awaited so this includes any promise it returns.
+    static constexpr std::chrono::milliseconds DefaultEvaluateTimeout = std::chrono::seconds(30);
+
 	const std::string ConstructFunctionCall(const char* value, const char* methodName, std::vector<JavaScript::JsFunctionConstructTypes> params);
 
-    JavaScript::EvalResult ExecuteOnSharedJsContext(std::string javaScriptEval);
-	PyObject* EvaluateFromSocket(std::string script);
-}
\ No newline at end of file
+    JavaScript::EvalResult ExecuteOnSharedJsContext(std::string javaScriptEval, std::chrono::milliseconds timeout = DefaultEvaluateTimeout);
+	PyObject* EvaluateFromSocket(std::string script, std::chrono::milliseconds timeout = DefaultEvaluateTimeout);
+}
\ No newline at end of file
@@ -1,4 +1,9 @@
 #include "ffi.h"
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
 
 PythonGIL::PythonGIL()
 {
@@ -32,4 +37,159 @@ const void PythonGIL::ReleaseAndUnLockGIL()
 {
     std::shared_ptr<PythonGIL> self = shared_from_this();
     self.reset();
-}
\ No newline at end of file
+}
+
+struct InterpreterLock::CachedThreadState
+{
+    PyInterpreterState* interpreter;
+    PyThreadState* threadState;
+    bool inUse = false;
+};
+
+namespace
+{
+    struct ThreadStateRegistry
+    {
+        std::mutex mutex;
+        std::condition_variable released;
+        std::vector<std::shared_ptr<InterpreterLock::CachedThreadState>> states;
+        std::unordered_set<int64_t> closingInterpreters; // by id, unlike their address an id is never reused
+    };
+
+    ThreadStateRegistry& GetRegistry()
+    {
+        // leaked on purpose, threads can exit after static destruction and still look here.
+        static ThreadStateRegistry* registry = new ThreadStateRegistry();
+        return *registry;
+    }
+
+    void Unregister(ThreadStateRegistry& registry, const std::shared_ptr<InterpreterLock::CachedThreadState>& cachedState)
+    {
+        registry.states.erase(std::remove(registry.states.begin(), registry.states.end(), cachedState), registry.states.end());
+    }
+
+    /* this thread's states, one per interpreter it has called into. there's only ever a handful, so a scan beats hashing. */
+    struct ThreadLocalStates
+    {
+        std::vector<std::shared_ptr<InterpreterLock::CachedThreadState>> states;
+
+        ~ThreadLocalStates()
+        {
+            ThreadStateRegistry& registry = GetRegistry();
+
+            for (const auto& cachedState : states)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(registry.mutex);
+
+                    // already freed by Purge(), or python is gone altogether.
+                    if (!cachedState->threadState || !Py_IsInitialized())
+                    {
+                        continue;
+                    }
+                    cachedState->inUse = true;
+                }
+
+                PyEval_RestoreThread(cachedState->threadState);
+                PyThreadState_Clear(cachedState->threadState);
+                PyThreadState_DeleteCurrent();
+
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                cachedState->threadState = nullptr;
+                cachedState->inUse = false;
+                Unregister(registry, cachedState);
+                registry.released.notify_all();
+            }
+        }
+    };
+
+    thread_local ThreadLocalStates threadLocalStates;
+}
+
+InterpreterLock::InterpreterLock(PyThreadState* interpreterThreadState)
+{
+    PyInterpreterState* interpreter = PyThreadState_GetInterpreter(interpreterThreadState);
+    ThreadStateRegistry& registry = GetRegistry();
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        if (registry.closingInterpreters.count(PyInterpreterState_GetID(interpreter)))
+        {
+            return;
+        }
+
+        auto& states = threadLocalStates.states;
+        states.erase(std::remove_if(states.begin(), states.end(), [](const auto& cachedState) { return !cachedState->threadState; }), states.end());
+
+        auto it = std::find_if(states.begin(), states.end(), [interpreter](const auto& cachedState) { return cachedState->interpreter == interpreter; });
+
+        if (it != states.end())
+        {
+            m_cachedState = *it;
+        }
+        else
+        {
+            m_cachedState = std::make_shared<CachedThreadState>(CachedThreadState { interpreter, PyThreadState_New(interpreter) });
+            states.push_back(m_cachedState);
+            registry.states.push_back(m_cachedState);
+        }
+        m_cachedState->inUse = true;
+    }
+    PyEval_RestoreThread(m_cachedState->threadState);
+}
+
+InterpreterLock::~InterpreterLock()
+{
+    if (!m_cachedState)
+    {
+        return;
+    }
+
+    PyEval_SaveThread();
+
+    ThreadStateRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    m_cachedState->inUse = false;
+    registry.released.notify_all();
+}
+
+void InterpreterLock::Purge(PyInterpreterState* interpreter)
+{
+    ThreadStateRegistry& registry = GetRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+    registry.closingInterpreters.insert(PyInterpreterState_GetID(interpreter));
+
+    const auto isInFlight = [&registry, interpreter]
+    {
+        return std::any_of(registry.states.begin(), registry.states.end(), [interpreter](const auto& cachedState) { 
+            return cachedState->interpreter == interpreter && cachedState->inUse; 
+        });
+    };
+
+    // callers that got in before the interpreter was closed are waiting on the GIL we hold, let them finish first.
+    while (isInFlight())
+    {
+        lock.unlock();
+        Py_BEGIN_ALLOW_THREADS
+        {
+            std::unique_lock<std::mutex> waitLock(registry.mutex);
+            registry.released.wait(waitLock, [&isInFlight] { return !isInFlight(); });
+        }
+        Py_END_ALLOW_THREADS
+        lock.lock();
+    }
+
+    for (auto it = registry.states.begin(); it != registry.states.end(); )
+    {
+        if ((*it)->interpreter != interpreter)
+        {
+            ++it;
+            continue;
+        }
+
+        PyThreadState_Clear((*it)->threadState);
+        PyThreadState_Delete((*it)->threadState);
+        (*it)->threadState = nullptr;
+        it = registry.states.erase(it);
+    }
+}
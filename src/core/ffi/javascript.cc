@@ -2,80 +2,79 @@
 #include <core/py_controller/co_spawn.h>
 #include <core/loader.h>
 #include <future>
+#include <core/cdp/client.h>
 
-#define SHARED_JS_EVALUATE_ID 54999
-
-#include <mutex>
-#include <condition_variable>
-
-JavaScript::EvalResult JavaScript::ExecuteOnSharedJsContext(std::string javaScriptEval)
+JavaScript::EvalResult JavaScript::ExecuteOnSharedJsContext(std::string javaScriptEval, std::chrono::milliseconds timeout)
 {
-    std::mutex mtx;
-    std::condition_variable cv;
-    JavaScript::EvalResult evalResult;
-    bool resultReady = false;  // Flag to indicate when the result is ready
-
-    bool messageSendSuccess = Sockets::PostShared(nlohmann::json({ 
-        { "id", SHARED_JS_EVALUATE_ID },
-        { "method", "Runtime.evaluate" }, 
-        { "params", {
-            { "expression", javaScriptEval }, 
-            { "awaitPromise", true }
-        }} 
-    }));
-
-    if (!messageSendSuccess) 
-    {
-        throw std::runtime_error("couldn't send message to socket");
-    }
-
-    std::string listenerId = JavaScript::SharedJSMessageEmitter::InstanceRef().OnMessage("msg", "ExecuteOnSharedJsContext", [&](const nlohmann::json& eventMessage, std::string listenerId) 
-    {
-        std::lock_guard<std::mutex> lock(mtx);  // Lock mutex for safe access
-
-        nlohmann::json response = eventMessage;
-        std::string method = response.value("method", std::string());
+    // shared with the response handler, it can outlive this frame if the deadline passes while the response is being dispatched.
+    auto evalPromise = std::make_shared<std::promise<JavaScript::EvalResult>>();
+    std::future<JavaScript::EvalResult> evalFuture = evalPromise->get_future();
 
-        if (method.find("Debugger") != std::string::npos || method.find("Console") != std::string::npos) 
-        {
-            return;
-        }
+    // on a plugin's own thread, which runs its queue while it waits (see below) until the response wakes it.
+    const PythonManager::Wakeup wakeup = PythonManager::GetWakeup();
 
+    const long long messageId = CDP::Client::InstanceRef().SendShared(CDP::Runtime::Evaluate { javaScriptEval, true, true },
+    [evalPromise, wakeup](const CDP::Message& message) 
+    {
         try 
         {
-            if (!response.contains("id") || (response.contains("id") && !response["id"].is_null() && response["id"] != SHARED_JS_EVALUATE_ID))
+            const auto& response = message.Json();
+
+            if (response.contains("error"))
             {
-                return;
+                // the evaluation never ran, i.e the session was detached or the socket closed.
+                evalPromise->set_exception(std::make_exception_ptr(std::runtime_error(response["error"].value("message", std::string("unknown CDP error")))));
             }
-
-            if (response["result"].contains("exceptionDetails"))
+            else if (response["result"].contains("exceptionDetails"))
             {
                 const std::string classType = response["result"]["exceptionDetails"]["exception"]["className"];
 
                 // Custom exception type thrown from CallFrontendMethod in executor.cc
                 if (classType == "MillenniumFrontEndError") 
-                    evalResult = { "__CONNECTION_ERROR__", false };
+                    evalPromise->set_value({ "__CONNECTION_ERROR__", false });
                 else
-                    evalResult = { response["result"]["exceptionDetails"]["exception"]["description"], false };
+                    evalPromise->set_value({ response["result"]["exceptionDetails"]["exception"]["description"], false });
             }
             else 
             {
-                evalResult = { response["result"]["result"], true };
+                evalPromise->set_value({ response["result"]["result"], true });
             }
-
-            resultReady = true;
-            cv.notify_one();  // Signal that result is ready
-            JavaScript::SharedJSMessageEmitter::InstanceRef().RemoveListener("msg", listenerId);
         }
         catch (nlohmann::detail::exception& ex) 
         {
-            LOG_ERROR(fmt::format("JavaScript::SharedJSMessageEmitter error -> {}", ex.what()));
+            LOG_ERROR("JavaScript::ExecuteOnSharedJsContext error -> {}", ex.what());
+            evalPromise->set_value({ ex.what(), false });
+        }
+
+        if (wakeup)
+        {
+            wakeup();
         }
     });
 
-    // Wait for the result to be ready
-    std::unique_lock<std::mutex> lock(mtx);
-    cv.wait(lock, [&] { return resultReady; });
+    if (messageId == 0) 
+    {
+        throw std::runtime_error("couldn't send message to socket");
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    const auto isReady = [&evalFuture] { return evalFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready; };
+
+    // on a plugin's own thread, keep its queue moving while we wait, the frontend may call back into the plugin before it answers.
+    if (!PythonManager::RunTasksUntil(isReady, deadline))
+    {
+        evalFuture.wait_until(deadline);
+    }
+
+    if (evalFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        // the handler may already be running, in which case the result is simply discarded.
+        CDP::Client::InstanceRef().Cancel(messageId);
+        throw JavaScript::TimeoutException(fmt::format("evaluation timed out after {} ms", timeout.count()));
+    }
+
+    JavaScript::EvalResult evalResult = evalFuture.get();
 
     if (!evalResult.successfulCall && evalResult.json == "__CONNECTION_ERROR__") 
     {
@@ -126,11 +125,29 @@ const std::string JavaScript::ConstructFunctionCall(const char* plugin, const ch
     strFunctionFormatted += ");"; return strFunctionFormatted;
 }
 
-PyObject* JavaScript::EvaluateFromSocket(std::string script)
+PyObject* JavaScript::EvaluateFromSocket(std::string script, std::chrono::milliseconds timeout)
 {
+    EvalResult response;
+    std::exception_ptr evalException;
+
+    // don't hold the GIL while waiting on the socket, other interpreters (and IPC calls into this one) would stall behind us.
+    Py_BEGIN_ALLOW_THREADS
+    try 
+    {
+        response = ExecuteOnSharedJsContext(script, timeout);
+    }
+    catch (...)
+    {
+        evalException = std::current_exception();
+    }
+    Py_END_ALLOW_THREADS
+
     try 
     {
-        EvalResult response = ExecuteOnSharedJsContext(script);
+        if (evalException)
+        {
+            std::rethrow_exception(evalException);
+        }
 
         if (!response.successfulCall) 
         {
@@ -138,13 +155,24 @@ PyObject* JavaScript::EvaluateFromSocket(std::string script)
             return NULL;
         }
 
-        std::string type = response.json["type"];
+        // evaluated by value, so objects and arrays arrive as plain JSON.
+        if (response.json.contains("unserializableValue"))
+        {
+            // NaN, Infinity, -0 or a bigint (i.e "12n")
+            const std::string value = response.json["unserializableValue"];
+
+            if (response.json.value("type", std::string()) == "bigint")
+                return PyLong_FromString(value.substr(0, value.size() - 1).c_str(), nullptr, 10);
+
+            return PyFloat_FromDouble(std::strtod(value.c_str(), nullptr));
+        }
+
+        if (!response.json.contains("value"))
+        {
+            Py_RETURN_NONE; // undefined
+        }
 
-        if      (type == "string") return PyUnicode_FromString(response.json["value"].get<std::string>().c_str());
-        else if (type == "boolean")   return PyBool_FromLong(response.json["value"]);
-        else if (type == "number")    return PyLong_FromLong(response.json["value"]);
-        else
-            return PyUnicode_FromString(fmt::format("Js function returned unaccepted type '{}'. Accepted types [string, boolean, number]", type).c_str());
+        return Python::FromJson(response.json["value"]);
 
     }
     catch (nlohmann::detail::exception& ex)
@@ -152,9 +180,14 @@ PyObject* JavaScript::EvaluateFromSocket(std::string script)
         std::string message = fmt::format("Millennium couldn't decode the response from {}, reason: {}", script, ex.what());
         return PyUnicode_FromString(message.c_str());
     }
-    catch (std::exception&)
+    catch (JavaScript::TimeoutException& ex)
+    {
+        PyErr_SetString(PyExc_TimeoutError, ex.what());
+        return NULL;
+    }
+    catch (std::exception& ex)
     {
-        PyErr_SetString(PyExc_ConnectionError, "frontend is not loaded!");
+        PyErr_SetString(PyExc_ConnectionError, fmt::format("frontend is not loaded! ({})", ex.what()).c_str());
         return NULL;
     }
 
@@ -3,6 +3,13 @@
 #include <sys/locals.h>
 #include <sys/log.h>
 #include <sys/asio.h>
+#include <sys/file_store.h>
+#include <sys/lru_cache.h>
+#include <sys/hash.h>
+#include <zlib.h>
+#include <charconv>
+#include <optional>
+#include <fstream>
 
 enum eFileType
 {
@@ -49,26 +56,377 @@ const bool IsInternalRequest(const std::filesystem::path& filepath)
 
 namespace Crow
 {
-    struct ResponseProps
+    SystemIO::FileStore& GetFileStore()
     {
-        std::string contentType;
-        std::string content;
-        bool exists;
+        static SystemIO::FileStore fileStore;
+        return fileStore;
+    }
+
+    /* what's actually sent for a file, the file itself or a compressed copy of it. */
+    struct Representation
+    {
+        std::shared_ptr<const std::string> body;
+        std::string etag;
+        std::string contentEncoding;
+    };
+
+    struct CompressedCopy
+    {
+        std::weak_ptr<const SystemIO::FileStore::File> source; // doesn't keep the file alive once the store drops it
+        std::shared_ptr<const std::string> body; // nullptr if compressing didn't make it any smaller
+    };
+
+    /// @return whether the Accept-Encoding header lists `encoding`, and doesn't refuse it with q=0.
+    bool AcceptsEncoding(const std::string& acceptEncoding, std::string_view encoding)
+    {
+        std::size_t position = 0;
+
+        while (position < acceptEncoding.size())
+        {
+            const std::size_t separator = std::min(acceptEncoding.find(',', position), acceptEncoding.size());
+            std::string_view coding = std::string_view(acceptEncoding).substr(position, separator - position);
+            position = separator + 1;
+
+            const std::size_t parameters = coding.find(';');
+            std::string_view name = coding.substr(0, parameters);
+
+            name.remove_prefix(std::min(name.find_first_not_of(' '), name.size()));
+            name.remove_suffix(name.size() - std::min(name.find_last_not_of(' ') + 1, name.size()));
+
+            if (name != encoding)
+            {
+                continue;
+            }
+
+            if (parameters == std::string_view::npos)
+            {
+                return true;
+            }
+
+            const std::size_t quality = coding.find("q=", parameters);
+            return quality == std::string_view::npos || std::strtod(std::string(coding.substr(quality + 2)).c_str(), nullptr) > 0;
+        }
+        return false;
+    }
+
+    /// @return the gzip'd input, or an empty string if zlib failed.
+    std::string GzipCompress(std::string_view input)
+    {
+        z_stream stream {};
+
+        // 15 bits of window plus 16 asks for a gzip header rather than a raw zlib stream.
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            return {};
+        }
+
+        std::string output(deflateBound(&stream, static_cast<uLong>(input.size())), '\0');
+
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream.avail_in = static_cast<uInt>(input.size());
+        stream.next_out = reinterpret_cast<Bytef*>(output.data());
+        stream.avail_out = static_cast<uInt>(output.size());
+
+        const int result = deflate(&stream, Z_FINISH);
+        output.resize(stream.total_out);
+        deflateEnd(&stream);
+
+        return result == Z_STREAM_END ? output : std::string();
+    }
+
+    /// @brief compress a file once per version of it, rather than once per request.
+    std::shared_ptr<const std::string> GetCompressedCopy(const std::filesystem::path& path, const std::shared_ptr<const SystemIO::FileStore::File>& file)
+    {
+        static std::mutex mutex;
+        static LruCache<std::string, CompressedCopy> compressedCopies { 16 * 1024 * 1024 };
+
+        const std::string key = path.lexically_normal().generic_string();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const CompressedCopy* cached = compressedCopies.Get(key);
+
+            if (cached && !cached->source.owner_before(file) && !file.owner_before(cached->source))
+            {
+                return cached->body;
+            }
+        }
+
+        std::string compressed = GzipCompress(file->contents);
+        std::shared_ptr<const std::string> body = !compressed.empty() && compressed.size() < file->contents.size() ? std::make_shared<const std::string>(std::move(compressed)) : nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        compressedCopies.Put(key, { file, body }, body ? body->size() : 1);
+        return body;
+    }
+
+    Representation SelectRepresentation(const crow::request& request, const std::filesystem::path& path, const std::shared_ptr<const SystemIO::FileStore::File>& file)
+    {
+        const std::string acceptEncoding = request.get_header_value("Accept-Encoding");
+
+        // precompressed siblings shipped next to the file win, as long as they aren't older than it.
+        for (const auto& [encoding, extension] : { std::pair { "br", ".br" }, std::pair { "gzip", ".gz" } })
+        {
+            if (!AcceptsEncoding(acceptEncoding, encoding))
+            {
+                continue;
+            }
+
+            const auto sibling = GetFileStore().Get(path.string() + extension);
+
+            if (sibling && sibling->lastWriteTime >= file->lastWriteTime)
+            {
+                return { std::shared_ptr<const std::string>(sibling, &sibling->contents), sibling->etag, encoding };
+            }
+        }
+
+        // images & fonts are compressed already, and tiny files aren't worth the header.
+        if (EvaluateFileType(path) != eFileType::Other && file->contents.size() >= 1024 && AcceptsEncoding(acceptEncoding, "gzip"))
+        {
+            if (auto compressed = GetCompressedCopy(path, file))
+            {
+                std::string etag = file->etag;
+                etag.insert(etag.size() - 1, "-gzip");
+
+                return { std::move(compressed), std::move(etag), "gzip" };
+            }
+        }
+
+        return { std::shared_ptr<const std::string>(file, &file->contents), file->etag, std::string() };
+    }
+
+    /// @return whether the client already has this exact version of the file.
+    bool IsCachedByClient(const crow::request& request, const std::string& etag)
+    {
+        const std::string ifNoneMatch = request.get_header_value("If-None-Match");
+
+        if (ifNoneMatch.empty())
+        {
+            return false;
+        }
+
+        std::size_t position = 0;
+
+        // a list of etags, or "*" for any version at all.
+        while (position < ifNoneMatch.size())
+        {
+            const std::size_t separator = std::min(ifNoneMatch.find(',', position), ifNoneMatch.size());
+            std::string_view candidate = std::string_view(ifNoneMatch).substr(position, separator - position);
+
+            candidate.remove_prefix(std::min(candidate.find_first_not_of(' '), candidate.size()));
+            candidate.remove_suffix(candidate.size() - std::min(candidate.find_last_not_of(' ') + 1, candidate.size()));
+
+            // If-None-Match uses the weak comparison, W/ prefixes don't matter.
+            if (candidate.substr(0, 2) == "W/")
+            {
+                candidate.remove_prefix(2);
+            }
+            if (candidate == "*" || candidate == (etag.rfind("W/", 0) == 0 ? std::string_view(etag).substr(2) : std::string_view(etag)))
+            {
+                return true;
+            }
+            position = separator + 1;
+        }
+        return false;
+    }
+
+    /* files at least this big are streamed from disk by crow instead of being kept in memory. */
+    constexpr std::uintmax_t LargeFileThreshold = 4 * 1024 * 1024;
+
+    /* the most a single range response reads into memory, clients ask for the rest with another request. */
+    constexpr std::uintmax_t MaxRangeLength = 8 * 1024 * 1024;
+
+    struct ByteRange
+    {
+        bool satisfiable;
+        std::uintmax_t first, last;
     };
 
-    ResponseProps EvaluateRequest(std::filesystem::path path)
+    /// @return the range asked for, or nullopt if there is none or it isn't one this server handles (i.e multiple ranges).
+    std::optional<ByteRange> ParseByteRange(const std::string& header, std::uintmax_t fileSize)
     {
-        eFileType fileType = EvaluateFileType(path.string());
-        const std::string contentType = fileTypes[fileType];
+        constexpr std::string_view unit = "bytes=";
 
-        return {
-            contentType,
-            SystemIO::ReadFileSync(path.string()),
-            std::filesystem::exists(path)
+        if (header.compare(0, unit.size(), unit) != 0 || header.find(',') != std::string::npos)
+        {
+            return std::nullopt;
+        }
+
+        const std::string_view spec = std::string_view(header).substr(unit.size());
+        const std::size_t dash = spec.find('-');
+
+        if (dash == std::string_view::npos)
+        {
+            return std::nullopt;
+        }
+
+        const auto parse = [](std::string_view digits, std::uintmax_t& value)
+        {
+            const auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+            return !digits.empty() && error == std::errc() && end == digits.data() + digits.size();
         };
+
+        const std::string_view firstDigits = spec.substr(0, dash), lastDigits = spec.substr(dash + 1);
+        std::uintmax_t first = 0, last = 0;
+
+        // "bytes=-500", the last 500 bytes.
+        if (firstDigits.empty())
+        {
+            if (!parse(lastDigits, last))
+            {
+                return std::nullopt;
+            }
+            if (last == 0 || fileSize == 0)
+            {
+                return ByteRange { false, 0, 0 };
+            }
+            return ByteRange { true, fileSize - std::min(last, fileSize), fileSize - 1 };
+        }
+
+        if (!parse(firstDigits, first) || (!lastDigits.empty() && (!parse(lastDigits, last) || last < first)))
+        {
+            return std::nullopt;
+        }
+
+        if (first >= fileSize)
+        {
+            return ByteRange { false, 0, 0 };
+        }
+        return ByteRange { true, first, lastDigits.empty() ? fileSize - 1 : std::min(last, fileSize - 1) };
+    }
+
+    /// @brief serve a large file without ever holding all of it in memory.
+    void ServeLargeFile(const crow::request& request, crow::response& response, const std::filesystem::path& path, std::uintmax_t fileSize)
+    {
+        std::error_code errorCode;
+        const auto lastWriteTime = std::filesystem::last_write_time(path, errorCode);
+
+        // hashing tens of megabytes for a strong ETag would defeat the point, this one only needs a stat.
+        const std::string etag = fmt::format("W/\"{:x}-{:x}\"", lastWriteTime.time_since_epoch().count(), fileSize);
+        const std::string contentType = fileTypes[EvaluateFileType(path)];
+
+        response.add_header("Content-Type", contentType);
+        response.add_header("Cache-Control", "no-cache");
+        response.add_header("ETag", etag);
+        response.add_header("Accept-Ranges", "bytes");
+
+        if (IsCachedByClient(request, etag))
+        {
+            response.code = 304;
+            return;
+        }
+
+        const auto range = ParseByteRange(request.get_header_value("Range"), fileSize);
+
+        if (!range.has_value())
+        {
+            // crow reads the file in chunks as the socket drains, the whole of it is never in memory.
+            response.set_static_file_info_unsafe(path.string());
+
+            // crow adds its own Content-Type from the extension, keep a single one and the same one the in-memory path sends.
+            response.set_header("Content-Type", contentType);
+            return;
+        }
+
+        if (!range->satisfiable)
+        {
+            response.code = 416;
+            response.add_header("Content-Range", fmt::format("bytes */{}", fileSize));
+            return;
+        }
+
+        const std::uintmax_t last = std::min(range->last, range->first + MaxRangeLength - 1);
+        std::ifstream fileStream(path, std::ios::binary);
+        std::string slice(static_cast<std::size_t>(last - range->first + 1), '\0');
+
+        if (!fileStream.seekg(static_cast<std::streamoff>(range->first)) || !fileStream.read(slice.data(), static_cast<std::streamsize>(slice.size())))
+        {
+            response.code = 500;
+            return;
+        }
+
+        response.code = 206;
+        response.add_header("Content-Range", fmt::format("bytes {}-{}/{}", range->first, last, fileSize));
+        response.body = std::move(slice);
+    }
+
+    /* a module that imports every enabled plugin frontend, so they're all fetched at once. */
+    struct FrontendBundle
+    {
+        std::string body;
+        std::string etag;
+    };
+
+    static std::mutex bundleMutex;
+    static std::shared_ptr<const FrontendBundle> frontendBundle;
+
+    void SetFrontendBundle(const std::vector<std::string>& moduleUrls)
+    {
+        auto bundle = std::make_shared<FrontendBundle>();
+
+        // static imports would link every frontend into one module graph, where a single one that fails to load or
+        // throws takes all of them down. each is imported on its own instead, all at once so they're still fetched in parallel.
+        bundle->body = "// generated by millennium, every frontend is imported on its own so one that fails doesn't stop the rest.\nconst frontends = [\n";
+
+        for (const auto& moduleUrl : moduleUrls)
+        {
+            std::string escapedUrl;
+
+            for (const char c : moduleUrl)
+            {
+                if (c == '\\' || c == '"')
+                {
+                    escapedUrl += '\\';
+                }
+                escapedUrl += c;
+            }
+            bundle->body.append(fmt::format("    \"{}\",\n", escapedUrl));
+        }
+
+        bundle->body.append(
+            "];\n"
+            "await Promise.all(frontends.map(url => import(url).catch(error => console.error(`millennium: failed to load ${url}`, error))));\n"
+        );
+
+        bundle->etag = fmt::format("\"{:016x}-{:x}\"", HashContents(bundle->body), bundle->body.size());
+
+        std::lock_guard<std::mutex> lock(bundleMutex);
+        frontendBundle = std::move(bundle);
+    }
+
+    crow::response HandleBundleRequest(const crow::request& request)
+    {
+        crow::response response;
+        std::shared_ptr<const FrontendBundle> bundle;
+        {
+            std::lock_guard<std::mutex> lock(bundleMutex);
+            bundle = frontendBundle;
+        }
+
+        response.add_header("Content-Type", fileTypes[eFileType::JavaScript]);
+        response.add_header("Access-Control-Allow-Origin", "*");
+
+        if (!bundle)
+        {
+            response.code = 404;
+            response.write("404 the frontend bundle hasn't been built yet.");
+            return response;
+        }
+
+        // the imports are revalidated on their own, the bundle only changes with the set of enabled plugins.
+        response.add_header("Cache-Control", "no-cache");
+        response.add_header("ETag", bundle->etag);
+
+        if (IsCachedByClient(request, bundle->etag))
+        {
+            response.code = 304;
+            return response;
+        }
+
+        response.write(bundle->body);
+        return response;
     }
 
-    crow::response HandleRequest(std::string path)
+    crow::response HandleRequest(const crow::request& request, std::string path)
     {
         crow::response response;
         std::filesystem::path absolutePath;
@@ -83,19 +441,47 @@ namespace Crow
             absolutePath = SystemIO::GetInstallPath() / "plugins" / path;
         }
 
-        ResponseProps responseProps = EvaluateRequest(absolutePath);
-
-        response.add_header("Content-Type", responseProps.contentType);
         response.add_header("Access-Control-Allow-Origin", "*");
 
-        if (!responseProps.exists)
+        std::error_code errorCode;
+        const std::uintmax_t fileSize = std::filesystem::file_size(absolutePath, errorCode);
+
+        if (!errorCode && fileSize >= LargeFileThreshold)
+        {
+            ServeLargeFile(request, response, absolutePath, fileSize);
+            return response;
+        }
+
+        response.add_header("Content-Type", fileTypes[EvaluateFileType(absolutePath)]);
+
+        const auto file = GetFileStore().Get(absolutePath);
+
+        if (!file)
         {
             response.code = 404;
             response.write(fmt::format("404 File not found: {}", absolutePath.string()));
             return response;
         }
 
-        response.write(responseProps.content);
+        const Representation representation = SelectRepresentation(request, absolutePath, file);
+
+        // plugins and themes change whenever they're toggled, so the client always asks, but a 304 is all it gets back.
+        response.add_header("Cache-Control", "no-cache");
+        response.add_header("ETag", representation.etag);
+        response.add_header("Vary", "Accept-Encoding");
+
+        if (!representation.contentEncoding.empty())
+        {
+            response.add_header("Content-Encoding", representation.contentEncoding);
+        }
+
+        if (IsCachedByClient(request, representation.etag))
+        {
+            response.code = 304;
+            return response;
+        }
+
+        response.write(*representation.body);
         return response;
     }
 
@@ -108,6 +494,7 @@ namespace Crow
         app->loglevel(crow::LogLevel::Critical);
         app->port(port);
 
+        CROW_ROUTE((*app), "/__bundle")(HandleBundleRequest);
         CROW_ROUTE((*app), "/<path>")(HandleRequest);
         return std::make_tuple(app, port);
     }
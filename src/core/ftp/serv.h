@@ -1,6 +1,18 @@
 #pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
 
 namespace Crow 
 {
     uint16_t CreateAsyncServer();
+
+    /**
+     * @brief publish the plugin frontends served as one module from /__bundle.
+     *
+     * The bundle has no exports. It imports every frontend with its own dynamic import(), so they're fetched in
+     * parallel and evaluated as they arrive rather than in list order, and one that fails is logged to the console
+     * without affecting the others. Importing the bundle settles once every frontend has loaded or failed.
+     */
+    void SetFrontendBundle(const std::vector<std::string>& moduleUrls);
 }
\ No newline at end of file
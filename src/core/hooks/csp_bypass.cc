@@ -0,0 +1,86 @@
+#include "csp_bypass.h"
+#include <core/cdp/client.h>
+#include <sys/log.h>
+
+CspBypass& CspBypass::InstanceRef()
+{
+    static CspBypass cspBypass;
+    return cspBypass;
+}
+
+void CspBypass::Start()
+{
+    CDP::Client& client = CDP::Client::InstanceRef();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bypassedTargets.clear();
+
+        if (!m_subscribed)
+        {
+            const auto handleTargetInfo = [this](const CDP::Message& message) { this->HandleTargetInfo(message.Json()["params"]["targetInfo"]); };
+
+            client.Subscribe(CDP::Method::Target_targetCreated,     handleTargetInfo);
+            client.Subscribe(CDP::Method::Target_targetInfoChanged, handleTargetInfo);
+            client.Subscribe(CDP::Method::Target_targetDestroyed,   [this](const CDP::Message& message)
+            {
+                this->HandleTargetDestroyed(message.Json()["params"]["targetId"]);
+            });
+            m_subscribed = true;
+        }
+    }
+
+    // also reports every target that already exists through targetCreated.
+    client.Send(CDP::Target::SetDiscoverTargets { true });
+}
+
+std::size_t CspBypass::BypassedTargets() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bypassedTargets.size();
+}
+
+void CspBypass::HandleTargetInfo(const nlohmann::json& targetInfo)
+{
+    const std::string& targetUrl = targetInfo["url"].get_ref<const std::string&>();
+
+    // make sure the only target none client pages. 
+    if (targetInfo["type"] != "page" || targetUrl.find("steamloopback.host") != std::string::npos || targetUrl.find("about:blank?") != std::string::npos)
+    {
+        return;
+    }
+
+    const std::string targetId = targetInfo["targetId"];
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_bypassedTargets.insert(targetId).second)
+        {
+            return;
+        }
+    }
+
+    CDP::Client& client = CDP::Client::InstanceRef();
+
+    client.Send(CDP::Target::AttachToTarget { targetId, true }, [this, &client, targetId](const CDP::Message& attached)
+    {
+        const auto sessionId = attached.FindString({ "result", "sessionId" });
+
+        if (!sessionId.has_value())
+        {
+            LOG_ERROR("failed to attach to {} to bypass its CSP.", targetId);
+
+            // give the next targetInfoChanged another shot at it.
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bypassedTargets.erase(targetId);
+            return;
+        }
+
+        client.Send(CDP::Page::SetBypassCSP { true }, nullptr, *sessionId);
+    });
+}
+
+void CspBypass::HandleTargetDestroyed(const std::string& targetId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bypassedTargets.erase(targetId);
+}
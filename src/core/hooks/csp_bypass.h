@@ -1,72 +1,33 @@
-#include <core/loader.h>
-#include <core/ffi/ffi.h>
-
-const void BypassCSP(void)
+#pragma once
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <nlohmann/json.hpp>
+
+/**
+ * Turns off the Content Security Policy of every non client page, so the modules injected into them are allowed
+ * to load. Targets are discovered through Target.targetCreated/targetInfoChanged, and each one is attached to and
+ * given Page.setBypassCSP exactly once for as long as it lives.
+ */
+class CspBypass
 {
-    // This function is used to bypass the Content Security Policy (CSP) of a website.
-    // The Content Security Policy (CSP) is a security standard that helps prevent cross-site scripting (XSS), clickjacking, and other code injection attacks resulting from execution of malicious content in the context of trusted web pages.
-    // The CSP is implemented by the web server and enforced by the web browser.
-    // The CSP is a set of rules that the web server sends to the web browser to tell it what content is allowed to be loaded
-
-    JavaScript::SharedJSMessageEmitter::InstanceRef().OnMessage("msg", "BypassCSP", [&](const nlohmann::json& message, std::string listenerId)
-    {
-        try
-        {
-            if (message.contains("id") && message.value("id", -1) == 96876) 
-            {
-                for (auto& target : message["result"]["targetInfos"])
-                {
-                    const std::string targetUrl = target["url"].get<std::string>();
+public:
+    static CspBypass& InstanceRef();
 
-                    // make sure the only target none client pages. 
-                    if (target["type"] == "page" && targetUrl.find("steamloopback.host") == std::string::npos && targetUrl.find("about:blank?") == std::string::npos)
-                    {
-                        Sockets::PostGlobal({
-                            { "id", 567844 },
-                            { "method", "Target.attachToTarget" },
-                            { "params", {
-                                { "targetId", target["targetId"] },
-                                { "flatten", true }
-                            }}
-                        });
+    /// @brief start discovering targets on a fresh connection, forgetting the targets of the last one.
+    void Start();
 
-                        // Logger.Log("Bypassing CSP for " + target["url"].get<std::string>());
-                    }
-                }
-            }
+    /// @return the number of targets CSP is bypassed on (or being bypassed on).
+    std::size_t BypassedTargets() const;
 
-            if (message.value("method", std::string()) == "Target.attachedToTarget")
-            {
-                Sockets::PostGlobal({
-                    { "id", 1235377 },
-                    { "method", "Page.setBypassCSP" },
-                    { "sessionId", message["params"]["sessionId"] },
-                    { "params", {
-                        { "enabled", true },
-                    }}
-                });
+private:
+    CspBypass() = default;
 
-                // Logger.Log("Sent CSP bypass request");
-            }
+    void HandleTargetInfo(const nlohmann::json& targetInfo);
+    void HandleTargetDestroyed(const std::string& targetId);
 
-            if (message.contains("id") && message.value("id", -1) == 1235377)
-            {
-                // Logger.Log("Successfully bypassed CSP");
-                JavaScript::SharedJSMessageEmitter::InstanceRef().RemoveListener("msg", listenerId);
-            }
-        }
-        catch (const nlohmann::detail::exception& e)
-        {
-            LOG_ERROR("error bypassing CSP -> {}", e.what());
-        }
-        catch(const std::exception& e)
-        {
-            LOG_ERROR("error bypassing CSP -> {}", e.what());
-        }
-    });
+    bool m_subscribed = false;
 
-    Sockets::PostGlobal({
-        { "id", 96876 },
-        { "method", "Target.getTargets" }
-    });
-}
\ No newline at end of file
+    mutable std::mutex m_mutex;
+    std::unordered_set<std::string> m_bypassedTargets;
+};
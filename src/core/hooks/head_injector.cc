@@ -0,0 +1,64 @@
+#include "head_injector.h"
+#include <cstring>
+#include <cctype>
+
+namespace
+{
+    constexpr std::string_view headTag = "head";
+
+    bool IsTagNameEnd(char c)
+    {
+        return c == '>' || c == '/' || std::isspace(static_cast<unsigned char>(c));
+    }
+
+    /// @return how many leading characters of `text` match the tag name, case insensitively.
+    std::size_t MatchTagName(std::string_view text)
+    {
+        std::size_t matched = 0;
+
+        while (matched < headTag.size() && matched < text.size() && std::tolower(static_cast<unsigned char>(text[matched])) == headTag[matched])
+        {
+            matched++;
+        }
+        return matched;
+    }
+}
+
+HeadInjector::Scan HeadInjector::FindInsertionPoint(std::string_view html)
+{
+    std::size_t position = 0;
+
+    while (position < html.size())
+    {
+        // memchr is vectorized by the c runtime, and '<' is rare enough in html that most of the text is skipped.
+        const void* found = std::memchr(html.data() + position, '<', html.size() - position);
+
+        if (found == nullptr)
+        {
+            break;
+        }
+
+        const std::size_t tagStart = static_cast<const char*>(found) - html.data();
+        const std::string_view tag = html.substr(tagStart + 1);
+        const std::size_t matched = MatchTagName(tag);
+
+        if (matched == tag.size() && matched <= headTag.size())
+        {
+            return { std::string_view::npos, tagStart }; // might still turn out to be <head> once more text arrives
+        }
+
+        if (matched == headTag.size() && IsTagNameEnd(tag[matched]))
+        {
+            const std::size_t tagEnd = html.find('>', tagStart + 1 + matched);
+
+            if (tagEnd == std::string_view::npos)
+            {
+                return { std::string_view::npos, tagStart };
+            }
+            return { tagEnd + 1, tagEnd + 1 };
+        }
+
+        position = tagStart + 1;
+    }
+    return { std::string_view::npos, html.size() };
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <string_view>
+#include <cstddef>
+
+namespace HeadInjector
+{
+    struct Scan
+    {
+        /// @brief offset just past the `>` that closes the first <head> tag, or npos if it wasn't found.
+        std::size_t insertAt;
+
+        /// @brief how much of the scanned text can't be part of a <head> tag, even if more text follows it.
+        std::size_t settled;
+    };
+
+    /**
+     * @brief find where the shim goes, right after the opening <head> tag. the tag is matched in any case and
+     * with or without attributes (i.e <HEAD> or <head lang="en">), but not as the start of <header>.
+     */
+    Scan FindInsertionPoint(std::string_view html);
+}
@@ -0,0 +1,302 @@
+#include "hook_matcher.h"
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+    bool IsMetaCharacter(char c)
+    {
+        switch (c)
+        {
+            case '^': case '$': case '.': case '|': case '?': case '*': case '+':
+            case '(': case ')': case '[': case ']': case '{': case '}':
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool IsLineTerminator(char c)
+    {
+        return c == '\n' || c == '\r';
+    }
+
+    bool HasAlternation(const std::string& source)
+    {
+        for (std::size_t i = 0; i < source.size(); i++)
+        {
+            if (source[i] == '\\')
+            {
+                i++;
+                continue;
+            }
+            if (source[i] == '|')
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+HookMatcher::Pattern HookMatcher::Compile(const std::string& source)
+{
+    // always compile, so invalid patterns are rejected no matter how they end up being matched.
+    auto regex = std::make_shared<const std::regex>(source);
+
+    // with an alternation there's no text every match is guaranteed to start with.
+    if (HasAlternation(source))
+    {
+        return { Kind::Regex, std::string(), regex };
+    }
+
+    std::string literal;
+    std::size_t index = (!source.empty() && source[0] == '^') ? 1 : 0;
+
+    while (index < source.size())
+    {
+        const char c = source[index];
+
+        if (c == '\\')
+        {
+            // escaped punctuation is literal, \d, \w, back references and friends are not.
+            if (index + 1 < source.size() && !std::isalnum(static_cast<unsigned char>(source[index + 1])))
+            {
+                literal += source[index + 1];
+                index += 2;
+                continue;
+            }
+            break;
+        }
+
+        if (IsMetaCharacter(c))
+        {
+            // the character before an optional quantifier might not be there at all.
+            if ((c == '?' || c == '*' || c == '{') && !literal.empty())
+            {
+                literal.pop_back();
+            }
+            break;
+        }
+
+        literal += c;
+        index++;
+    }
+
+    const std::string_view remainder = std::string_view(source).substr(std::min(index, source.size()));
+
+    if (remainder.empty() || remainder == "$")
+    {
+        return { Kind::Exact, std::move(literal), nullptr };
+    }
+    if (remainder == ".*" || remainder == ".*$")
+    {
+        return { Kind::Prefix, std::move(literal), nullptr };
+    }
+
+    Pattern wildcard { Kind::Wildcard, literal, nullptr };
+
+    for (std::size_t i = 0; i < remainder.size(); i++)
+    {
+        const char c = remainder[i];
+
+        if (remainder.substr(i) == ".*" || remainder.substr(i) == ".*$")
+        {
+            wildcard.openEnded = true;
+            return wildcard;
+        }
+        if (remainder.substr(i) == "$")
+        {
+            return wildcard;
+        }
+
+        if (c == '\\' && i + 1 < remainder.size() && !std::isalnum(static_cast<unsigned char>(remainder[i + 1])))
+        {
+            wildcard.tail += remainder[++i];
+            wildcard.tailAnyCharacter.push_back(false);
+            continue;
+        }
+
+        // anything quantified or any other regex syntax needs the real regex.
+        const bool quantified = i + 1 < remainder.size() && (remainder[i + 1] == '*' || remainder[i + 1] == '+' || remainder[i + 1] == '?' || remainder[i + 1] == '{');
+
+        if (quantified || (IsMetaCharacter(c) && c != '.') || c == '\\')
+        {
+            return { Kind::Regex, std::move(literal), regex };
+        }
+
+        wildcard.tail += c;
+        wildcard.tailAnyCharacter.push_back(c == '.');
+    }
+    return wildcard;
+}
+
+std::string HookMatcher::ToGlob(const Pattern& pattern)
+{
+    std::string glob;
+
+    const auto appendLiteral = [&glob](char c)
+    {
+        if (c == '*' || c == '?' || c == '\\')
+        {
+            glob += '\\';
+        }
+        glob += c;
+    };
+
+    for (const char c : pattern.literal)
+    {
+        appendLiteral(c);
+    }
+
+    switch (pattern.kind)
+    {
+        case Kind::Exact:
+        {
+            return glob;
+        }
+        case Kind::Wildcard:
+        {
+            for (std::size_t i = 0; i < pattern.tail.size(); i++)
+            {
+                if (pattern.tailAnyCharacter[i])
+                {
+                    glob += '?';
+                    continue;
+                }
+                appendLiteral(pattern.tail[i]);
+            }
+            return pattern.openEnded ? glob + "*" : glob;
+        }
+        default:
+        {
+            return glob + "*";
+        }
+    }
+}
+
+HookMatcher::HookMatcher(const std::vector<Pattern>& patterns) : m_patterns(patterns)
+{
+    m_nodes.emplace_back();
+
+    for (std::size_t index = 0; index < m_patterns.size(); index++)
+    {
+        std::size_t node = 0;
+
+        for (const char c : m_patterns[index].literal)
+        {
+            auto& children = m_nodes[node].children;
+            auto child = std::find_if(children.begin(), children.end(), [c](const auto& edge) { return edge.first == c; });
+
+            if (child != children.end())
+            {
+                node = child->second;
+                continue;
+            }
+
+            const std::size_t next = m_nodes.size();
+            children.emplace_back(c, next);
+            m_nodes.emplace_back();
+            node = next;
+        }
+
+        auto& target = m_patterns[index].kind == Kind::Exact ? m_nodes[node].exact : m_nodes[node].anchored;
+        target.push_back(index);
+    }
+}
+
+bool HookMatcher::Verify(std::size_t index, std::string_view url) const
+{
+    const Pattern& pattern = m_patterns[index];
+
+    switch (pattern.kind)
+    {
+        case Kind::Exact:
+        {
+            return true;
+        }
+        case Kind::Prefix:
+        {
+            // `.` doesn't match line terminators.
+            return url.find_first_of("\r\n", pattern.literal.size()) == std::string_view::npos;
+        }
+        case Kind::Wildcard:
+        {
+            const std::string_view rest = url.substr(pattern.literal.size());
+
+            if (rest.size() < pattern.tail.size() || (!pattern.openEnded && rest.size() != pattern.tail.size()))
+            {
+                return false;
+            }
+
+            for (std::size_t i = 0; i < pattern.tail.size(); i++)
+            {
+                if (pattern.tailAnyCharacter[i] ? IsLineTerminator(rest[i]) : rest[i] != pattern.tail[i])
+                {
+                    return false;
+                }
+            }
+            return !pattern.openEnded || rest.find_first_of("\r\n", pattern.tail.size()) == std::string_view::npos;
+        }
+        default:
+        {
+            return std::regex_match(url.begin(), url.end(), *pattern.regex);
+        }
+    }
+}
+
+template <typename Visitor>
+void HookMatcher::VisitCandidates(std::string_view url, Visitor&& visitor) const
+{
+    std::size_t node = 0;
+
+    for (std::size_t index : m_nodes[node].anchored)
+    {
+        visitor(index);
+    }
+
+    for (const char c : url)
+    {
+        const auto& children = m_nodes[node].children;
+        auto child = std::find_if(children.begin(), children.end(), [c](const auto& edge) { return edge.first == c; });
+
+        if (child == children.end())
+        {
+            return;
+        }
+
+        node = child->second;
+
+        for (std::size_t index : m_nodes[node].anchored)
+        {
+            visitor(index);
+        }
+    }
+
+    // the whole url was consumed, so literals ending here are an exact match.
+    for (std::size_t index : m_nodes[node].exact)
+    {
+        visitor(index);
+    }
+}
+
+std::vector<std::size_t> HookMatcher::Match(std::string_view url) const
+{
+    std::vector<std::size_t> matches;
+
+    this->VisitCandidates(url, [&](std::size_t index)
+    {
+        if (this->Verify(index, url))
+        {
+            matches.push_back(index);
+        }
+    });
+
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
+
+bool HookMatcher::MatchesAny(std::string_view url) const
+{
+    return !this->Match(url).empty();
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <regex>
+
+/**
+ * Matches a url against a set of hook patterns in one pass.
+ *
+ * Patterns keep std::regex_match semantics, but most hook patterns are `.*`, a plain url, or a literal prefix
+ * followed by `.*`, none of which need a regex. Each pattern is split into the literal text every match has to
+ * start with and whatever follows it, and the literals are laid out in a prefix trie. Walking the url down the
+ * trie once yields every candidate, and a regex only runs for the candidates that can't be decided from the
+ * literal alone.
+ */
+class HookMatcher
+{
+public:
+    enum class Kind
+    {
+        Exact,    // the whole pattern is literal text
+        Prefix,   // literal text followed by `.*`
+        Wildcard, // literal text and unescaped `.`s, optionally followed by `.*`. the usual "https://host.name/.*"
+        Regex     // literal text followed by anything else, verified with the regex
+    };
+
+    struct Pattern
+    {
+        Kind kind;
+        std::string literal;
+        std::shared_ptr<const std::regex> regex;
+
+        // Wildcard only, what follows the literal. a '.' in `tail` matches any character if `tailAnyCharacter`
+        // is set at the same position.
+        std::string tail;
+        std::vector<bool> tailAnyCharacter;
+        bool openEnded = false;
+    };
+
+    /// @throws std::regex_error if the pattern isn't a valid regex.
+    static Pattern Compile(const std::string& source);
+
+    /**
+     * @return a glob (`*` any run of characters, `?` any one character, `\` escapes) that matches at least every
+     * url the pattern does, i.e for CDP's Fetch.RequestPattern. Regex patterns widen to their literal prefix.
+     */
+    static std::string ToGlob(const Pattern& pattern);
+
+    HookMatcher() : HookMatcher(std::vector<Pattern>()) {}
+    explicit HookMatcher(const std::vector<Pattern>& patterns);
+
+    /// @return the indices of the patterns that match, in ascending order.
+    std::vector<std::size_t> Match(std::string_view url) const;
+    bool MatchesAny(std::string_view url) const;
+
+private:
+    struct Node
+    {
+        std::vector<std::pair<char, std::size_t>> children;
+        std::vector<std::size_t> anchored; // Prefix & Regex patterns whose literal ends here
+        std::vector<std::size_t> exact;
+    };
+
+    std::vector<Pattern> m_patterns;
+    std::vector<Node> m_nodes;
+
+    bool Verify(std::size_t index, std::string_view url) const;
+
+    template <typename Visitor>
+    void VisitCandidates(std::string_view url, Visitor&& visitor) const;
+};
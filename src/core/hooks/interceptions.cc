@@ -0,0 +1,114 @@
+#include "interceptions.h"
+
+static constexpr std::size_t initialCapacity = 16;
+
+PendingInterceptions::PendingInterceptions()
+{
+    m_slots.resize(initialCapacity);
+}
+
+std::size_t PendingInterceptions::IndexFor(long long hookId) const
+{
+    // hook ids are sequential, mix them so neighbours don't cluster into one probe run.
+    unsigned long long hash = static_cast<unsigned long long>(hookId);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    return static_cast<std::size_t>(hash) & (m_slots.size() - 1);
+}
+
+void PendingInterceptions::Rehash(std::size_t capacity)
+{
+    std::vector<Slot> previous = std::move(m_slots);
+
+    m_slots.clear();
+    m_slots.resize(capacity);
+    m_occupied = m_deleted = 0;
+
+    for (auto& slot : previous)
+    {
+        if (slot.state == SlotState::Occupied)
+        {
+            std::size_t index = this->IndexFor(slot.interception.hookId);
+
+            while (m_slots[index].state == SlotState::Occupied)
+            {
+                index = (index + 1) & (m_slots.size() - 1);
+            }
+
+            m_slots[index].state = SlotState::Occupied;
+            m_slots[index].interception = std::move(slot.interception);
+            m_occupied++;
+        }
+    }
+}
+
+void PendingInterceptions::Insert(Interception interception)
+{
+    // keep probe runs short, deleted slots count towards the load as they still have to be probed past.
+    if ((m_occupied + m_deleted + 1) * 2 > m_slots.size())
+    {
+        this->Rehash(m_occupied * 4 > m_slots.size() ? m_slots.size() * 2 : m_slots.size());
+    }
+
+    std::size_t index = this->IndexFor(interception.hookId);
+
+    while (m_slots[index].state == SlotState::Occupied)
+    {
+        index = (index + 1) & (m_slots.size() - 1);
+    }
+
+    if (m_slots[index].state == SlotState::Deleted)
+    {
+        m_deleted--;
+    }
+
+    m_slots[index].state = SlotState::Occupied;
+    m_slots[index].interception = std::move(interception);
+    m_occupied++;
+    m_inFlight.store(m_occupied, std::memory_order_relaxed);
+}
+
+std::optional<PendingInterceptions::Interception> PendingInterceptions::Take(long long hookId)
+{
+    std::size_t index = this->IndexFor(hookId);
+
+    while (m_slots[index].state != SlotState::Empty)
+    {
+        Slot& slot = m_slots[index];
+
+        if (slot.state == SlotState::Occupied && slot.interception.hookId == hookId)
+        {
+            Interception interception = std::move(slot.interception);
+            slot.state = SlotState::Deleted;
+            m_occupied--;
+            m_deleted++;
+            m_inFlight.store(m_occupied, std::memory_order_relaxed);
+            return interception;
+        }
+        index = (index + 1) & (m_slots.size() - 1);
+    }
+    return std::nullopt;
+}
+
+std::vector<PendingInterceptions::Interception> PendingInterceptions::Expire(std::chrono::steady_clock::duration maxAge)
+{
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<Interception> expired;
+
+    for (auto& slot : m_slots)
+    {
+        if (slot.state == SlotState::Occupied && now - slot.interception.createdAt > maxAge)
+        {
+            expired.push_back(std::move(slot.interception));
+            slot.interception = {};
+            slot.state = SlotState::Deleted;
+            m_occupied--;
+            m_deleted++;
+        }
+    }
+
+    m_inFlight.store(m_occupied, std::memory_order_relaxed);
+    return expired;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <optional>
+#include <chrono>
+#include <atomic>
+
+/**
+ * Documents whose body has been requested with Fetch.getResponseBody and not yet fulfilled, keyed by the
+ * (negative) id the body was requested with. Entries hold only what's needed to fulfill the request.
+ *
+ * Open addressing with linear probing, so a lookup is a hash and a short probe instead of a walk over every
+ * pending document. Only touched from the socket thread, InFlight() may be read from anywhere.
+ */
+class PendingInterceptions
+{
+public:
+    struct Interception
+    {
+        long long hookId;
+        std::string requestId;
+        std::string url;
+        int statusCode;
+        std::string statusText;
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::chrono::steady_clock::time_point createdAt;
+    };
+
+    PendingInterceptions();
+
+    void Insert(Interception interception);
+    /// @brief remove and return the interception waiting on hookId, if there is one.
+    std::optional<Interception> Take(long long hookId);
+
+    /// @brief remove entries whose body hasn't arrived in time, i.e the page was closed mid-load or the body is stuck.
+    /// @return the removed entries, their requests are still paused in the browser until they're continued.
+    std::vector<Interception> Expire(std::chrono::steady_clock::duration maxAge);
+
+    std::size_t InFlight() const { return m_inFlight.load(std::memory_order_relaxed); }
+
+private:
+    enum class SlotState : unsigned char { Empty, Occupied, Deleted };
+
+    struct Slot
+    {
+        SlotState state = SlotState::Empty;
+        Interception interception;
+    };
+
+    std::vector<Slot> m_slots;
+    std::size_t m_occupied = 0, m_deleted = 0;
+    std::atomic<std::size_t> m_inFlight { 0 };
+
+    std::size_t IndexFor(long long hookId) const;
+    void Rehash(std::size_t capacity);
+};
@@ -0,0 +1,39 @@
+#include "module_cache.h"
+#include <sys/encoding.h>
+
+std::shared_ptr<const ModuleCache::Module> ModuleCache::Get(const std::filesystem::path& filePath)
+{
+    const std::string key = filePath.lexically_normal().generic_string();
+    const auto file = m_files.Get(filePath);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!file)
+    {
+        m_modules.Remove(key);
+        return nullptr;
+    }
+
+    const auto* cached = m_modules.Get(key);
+
+    if (cached && !(*cached)->source.owner_before(file) && !file.owner_before((*cached)->source))
+    {
+        return *cached;
+    }
+
+    auto module = std::make_shared<Module>();
+    module->source = file;
+    module->encodedBody = Base64Encode(file->contents);
+    module->etag = file->etag;
+
+    module->headers = {
+        { "Access-Control-Allow-Origin", "*" },
+        { "Content-Type", "application/javascript" },
+        { "Content-Length", std::to_string(file->contents.size()) },
+        { "Cache-Control", "no-cache" },
+        { "ETag", file->etag }
+    };
+
+    m_modules.Put(key, module, module->encodedBody.size());
+    return module;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <filesystem>
+#include <sys/file_store.h>
+#include <sys/lru_cache.h>
+
+/**
+ * Plugin modules served through the virtual url, kept ready to hand to Fetch.fulfillRequest.
+ *
+ * Each version of a module is base64 encoded once and stored with its response headers, for as long as the
+ * file store hands out the same copy of the file. At most `ModuleCapacity` bytes of encoded modules are kept.
+ */
+class ModuleCache
+{
+public:
+    struct Module
+    {
+        std::weak_ptr<const SystemIO::FileStore::File> source;
+
+        std::string encodedBody;
+        std::string etag;
+        std::vector<std::pair<std::string, std::string>> headers;
+    };
+
+    /// @return the module, or nullptr if it can't be read.
+    std::shared_ptr<const Module> Get(const std::filesystem::path& filePath);
+
+private:
+    static constexpr std::size_t ModuleCapacity = 32 * 1024 * 1024;
+
+    SystemIO::FileStore m_files;
+
+    std::mutex m_mutex;
+    LruCache<std::string, std::shared_ptr<const Module>> m_modules { ModuleCapacity };
+};
@@ -1,39 +1,230 @@
 #include "web_load.h"
 #include <nlohmann/json.hpp>
 #include <core/loader.h>
+#include <core/cdp/client.h>
 #include <core/ffi/ffi.h>
 #include <sys/encoding.h>
+#include <sys/hash.h>
 #include <sys/http.h>   
+#include <sys/file_cache.h>
+#include "module_cache.h"
+#include "head_injector.h"
 #include <unordered_set>
 #include "csp_bypass.h"
 
-unsigned long long g_hookedModuleId;
+static unsigned long long g_hookedModuleId;
 
 // These URLS are blacklisted from being hooked, to prevent potential security issues.
 static const std::vector<std::string> g_blackListedUrls = {
     "https://checkout\\.steampowered\\.com/.*"
 };
 
+/// @return the response's Content-Length, or 0 if it didn't send a usable one.
+static unsigned long long GetContentLength(const std::vector<std::pair<std::string, std::string>>& headers)
+{
+    for (const auto& [name, value] : headers)
+    {
+        const bool isContentLength = std::equal(name.begin(), name.end(), "content-length", "content-length" + 14, [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+
+        if (isContentLength)
+        {
+            return std::strtoull(value.c_str(), nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+static const HookMatcher& GetBlackListMatcher()
+{
+    static const HookMatcher blackListMatcher = []
+    {
+        std::vector<HookMatcher::Pattern> patterns;
+
+        for (const auto& blackListedUrl : g_blackListedUrls)
+        {
+            patterns.push_back(HookMatcher::Compile(blackListedUrl));
+        }
+        return HookMatcher(patterns);
+    }();
+
+    return blackListMatcher;
+}
+
 WebkitHandler WebkitHandler::get() 
 {
     static WebkitHandler webkitHandler;
     return webkitHandler;
 }
 
-void WebkitHandler::SetupGlobalHooks() 
+/* webkit_api.js, already wrapped up to the point where the hooked modules are passed in. */
+static std::shared_ptr<const std::string> GetWebkitShimPrelude()
 {
-    Sockets::PostGlobal({
-        { "id", 3242 }, { "method", "Fetch.enable" },
-        { "params", {
-            { "patterns", {
-                { { "urlPattern", "*" }, { "resourceType", "Document" }, { "requestStage", "Response" } },     
-                { { "urlPattern", fmt::format("{}*", this->m_javaScriptVirtualUrl) }, { "requestStage", "Request" } }
-            }
-        }}}
+    static SystemIO::CachedFile webkitShim(SystemIO::GetInstallPath() / "ext" / "data" / "shims" / "webkit_api.js", [](std::string source)
+    {
+        return source.empty() ? std::string() : fmt::format("<script type=\"module\" id=\"millennium-injected\" defer>{}millennium_components(", source);
     });
+
+    return webkitShim.Get();
+}
+
+static ModuleCache& GetModuleCache()
+{
+    static ModuleCache moduleCache;
+    return moduleCache;
 }
 
-bool WebkitHandler::IsGetBodyCall(nlohmann::basic_json<> message) 
+static bool IsCachedByBrowser(const nlohmann::json& request, const std::string& etag)
+{
+    if (!request.contains("headers"))
+    {
+        return false;
+    }
+
+    for (const auto& [name, value] : request["headers"].items())
+    {
+        const bool isIfNoneMatch = std::equal(name.begin(), name.end(), "if-none-match", "if-none-match" + 13, [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+
+        if (isIfNoneMatch && value.is_string())
+        {
+            return value.get_ref<const std::string&>() == etag;
+        }
+    }
+    return false;
+}
+
+unsigned long long WebkitHandler::AddHook(std::string path, const std::string& urlPattern, TagTypes type)
+{
+    HookMatcher::Pattern pattern = HookMatcher::Compile(urlPattern);
+    unsigned long long hookId;
+    {
+        std::lock_guard<std::mutex> lock(m_hookRegistry->mutex);
+        hookId = ++g_hookedModuleId;
+
+        m_hookRegistry->hooks.push_back({ std::move(path), std::move(pattern), type, hookId });
+        m_hookRegistry->generation++;
+    }
+
+    this->UpdateFetchPatterns(false);
+    return hookId;
+}
+
+bool WebkitHandler::RemoveHook(unsigned long long hookId)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_hookRegistry->mutex);
+        auto& hooks = m_hookRegistry->hooks;
+
+        const auto it = std::remove_if(hooks.begin(), hooks.end(), [hookId](const HookType& hook) { return hook.id == hookId; });
+
+        if (it == hooks.end())
+        {
+            return false;
+        }
+
+        hooks.erase(it, hooks.end());
+        m_hookRegistry->generation++;
+    }
+
+    this->UpdateFetchPatterns(false);
+    return true;
+}
+
+void WebkitHandler::UpdateFetchPatterns(bool force)
+{
+    std::lock_guard<std::mutex> lock(m_hookRegistry->mutex);
+
+    // Fetch is enabled once the browser is connected, until then there's nothing to update.
+    if (!force && !m_hookRegistry->fetchEnabled)
+    {
+        return;
+    }
+
+    std::vector<std::string> documentPatterns;
+
+    for (const auto& hook : m_hookRegistry->hooks)
+    {
+        documentPatterns.push_back(HookMatcher::ToGlob(hook.urlPattern));
+    }
+
+    std::sort(documentPatterns.begin(), documentPatterns.end());
+    documentPatterns.erase(std::unique(documentPatterns.begin(), documentPatterns.end()), documentPatterns.end());
+
+    // "*" already covers everything else. a plugin without "webkitPatterns" in its plugin.json hooks ".*", so with any
+    // such plugin enabled this collapses to "*" and every document is paused.
+    if (std::find(documentPatterns.begin(), documentPatterns.end(), "*") != documentPatterns.end())
+    {
+        documentPatterns = { "*" };
+    }
+
+    if (!force && documentPatterns == m_hookRegistry->fetchPatterns)
+    {
+        return;
+    }
+
+    m_hookRegistry->fetchEnabled = true;
+    m_hookRegistry->fetchPatterns = documentPatterns;
+
+    const std::string virtualUrlPattern = fmt::format("{}*", this->m_javaScriptVirtualUrl);
+    std::vector<CDP::Fetch::RequestPattern> patterns;
+
+    for (const auto& documentPattern : m_hookRegistry->fetchPatterns)
+    {
+        patterns.push_back({ documentPattern, "Document", "Response" });
+    }
+    patterns.push_back({ virtualUrlPattern, std::nullopt, "Request" });
+
+    // sent under the lock, so the last Fetch.enable the browser sees is always the newest pattern set.
+    CDP::Client::InstanceRef().Send(CDP::Fetch::Enable { std::move(patterns) });
+}
+
+std::shared_ptr<WebkitHandler::CompiledHooks> WebkitHandler::GetCompiledHooks()
+{
+    std::lock_guard<std::mutex> lock(m_hookRegistry->mutex);
+    auto& compiled = m_hookRegistry->compiled;
+
+    // only rebuilt when a hook was added or removed since the last document.
+    if (!compiled || compiled->generation != m_hookRegistry->generation)
+    {
+        std::vector<HookMatcher::Pattern> patterns;
+        patterns.reserve(m_hookRegistry->hooks.size());
+
+        for (const auto& hook : m_hookRegistry->hooks)
+        {
+            patterns.push_back(hook.urlPattern);
+        }
+
+        compiled = std::make_shared<CompiledHooks>();
+        compiled->generation = m_hookRegistry->generation;
+        compiled->hooks = m_hookRegistry->hooks;
+        compiled->matcher = HookMatcher(patterns);
+    }
+    return compiled;
+}
+
+std::vector<std::size_t> WebkitHandler::CompiledHooks::Match(const std::string& url)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    if (const auto* cached = matchCache.Get(url))
+    {
+        return *cached;
+    }
+
+    std::vector<std::size_t> matches = matcher.Match(url);
+    matchCache.Put(url, matches);
+    return matches;
+}
+
+void WebkitHandler::SetupGlobalHooks() 
+{
+    m_streamResponseBodies = SettingsStore().GetSetting("stream_document_bodies", "true") == "true";
+    m_preloadModules = SettingsStore().GetSetting("preload_webkit_modules", "true") == "true";
+
+    this->UpdateFetchPatterns(true);
+    CspBypass::InstanceRef().Start();
+}
+
+bool WebkitHandler::IsGetBodyCall(const nlohmann::json& message) 
 {
     return message["params"]["request"]["url"].get<std::string>().find(this->m_javaScriptVirtualUrl) != std::string::npos;
 }
@@ -50,102 +241,308 @@ std::filesystem::path WebkitHandler::ConvertToLoopBack(std::string requestUrl)
     return SystemIO::GetSteamPath() / requestUrl;
 }
 
-void WebkitHandler::RetrieveRequestFromDisk(nlohmann::basic_json<> message)
+void WebkitHandler::RetrieveRequestFromDisk(const nlohmann::json& message)
 {
-    std::filesystem::path localFilePath = this->ConvertToLoopBack(message["params"]["request"]["url"]);
-    std::ifstream localFileStream(localFilePath);
+    const auto& request = message["params"]["request"];
+    const std::string& requestId = message["params"]["requestId"].get_ref<const std::string&>();
 
-    bool bFailedRead = !localFileStream.is_open();
+    std::filesystem::path localFilePath = this->ConvertToLoopBack(request["url"]);
+    const auto module = GetModuleCache().Get(localFilePath);
 
-    if (bFailedRead)
+    if (!module)
     {
-        LOG_ERROR("failed to retrieve file info from disk.");
+        LOG_ERROR("failed to retrieve file info from disk -> {}", localFilePath.string());
+
+        const std::string responseMessage = "millennium couldn't read " + localFilePath.string();
+        CDP::Client::InstanceRef().Send(CDP::Fetch::FulfillRequest { requestId, 404, std::vector<CDP::Fetch::HeaderEntry> { { "Access-Control-Allow-Origin", "*" } }, "", responseMessage });
+        return;
     }
 
-    const std::string fileContent((std::istreambuf_iterator<char>(localFileStream)), std::istreambuf_iterator<char>());
+    std::vector<CDP::Fetch::HeaderEntry> responseHeaders;
+    responseHeaders.reserve(module->headers.size());
 
-    const int responseCode            = bFailedRead ? 404 : 200;
-    const std::string responseMessage = bFailedRead ? "millennium" : "millennium couldn't read " + localFilePath.string();
+    for (const auto& [name, value] : module->headers)
+    {
+        responseHeaders.push_back({ name, value });
+    }
 
-    const nlohmann::json responseHeaders = nlohmann::json::array
-    ({
-        { {"name", "Access-Control-Allow-Origin"}, {"value", "*"} },
-        { {"name", "Content-Type"}, {"value", "application/javascript"} }
-    });
+    // the browser revalidates its copy since it's served as no-cache, skip the body if it's still current.
+    if (IsCachedByBrowser(request, module->etag))
+    {
+        CDP::Client::InstanceRef().Send(CDP::Fetch::FulfillRequest { requestId, 304, std::move(responseHeaders), std::nullopt, "Not Modified" });
+        return;
+    }
 
-    Sockets::PostGlobal({
-        { "id", 63453 },
-        { "method", "Fetch.fulfillRequest" },
-        { "params", {
-            { "responseCode", responseCode },
-            { "requestId", message["params"]["requestId"] },
-            { "responseHeaders", responseHeaders },
-            { "responsePhrase", responseMessage },
-            { "body", Base64Encode(fileContent) }
-        }}
-    });
+    CDP::Client::InstanceRef().Send(CDP::Fetch::FulfillRequest { requestId, 200, std::move(responseHeaders), module->encodedBody, "millennium" });
 }
 
-void WebkitHandler::GetResponseBody(nlohmann::basic_json<> message)
+void WebkitHandler::GetResponseBody(const nlohmann::json& message)
 {
     const RedirectType statusCode = message["params"]["responseStatusCode"].get<RedirectType>();
 
     // If the status code is a redirect, we just continue the request. 
     if (statusCode == REDIRECT || statusCode == MOVED_PERMANENTLY || statusCode == FOUND || statusCode == TEMPORARY_REDIRECT || statusCode == PERMANENT_REDIRECT)
     {
-        Sockets::PostGlobal({
-            { "id", 0 },
-            { "method", "Fetch.continueRequest" },
-            { "params", { { "requestId", message["params"]["requestId"] } }}
-        });
+        CDP::Client::InstanceRef().Send(CDP::Fetch::ContinueRequest { message["params"]["requestId"].get_ref<const std::string&>() });
     }
     else
     {
-        hookMessageId -= 1;
-        m_requestMap->push_back({ hookMessageId, message["params"]["requestId"], message["params"]["resourceType"], message });
+        const auto& params = message["params"];
+        const std::string& requestId = params["requestId"].get_ref<const std::string&>();
 
-        Sockets::PostGlobal({
-            { "id", hookMessageId },
-            { "method", "Fetch.getResponseBody" },
-            { "params", { { "requestId", message["params"]["requestId"] } }}
-        });
+        std::optional<std::string> shimContent = this->BuildShimContent(params["request"]["url"]);
+
+        // nothing to inject, hand the document back to the browser without ever reading it.
+        if (!shimContent.has_value() || shimContent->empty())
+        {
+            CDP::Client::InstanceRef().Send(CDP::Fetch::ContinueRequest { requestId });
+            return;
+        }
+
+        PendingInterceptions::Interception interception {
+            0,
+            params["requestId"],
+            params["request"]["url"],
+            params.value("responseStatusCode", 200),
+            params.value("responseStatusText", std::string()),
+            {},
+            std::chrono::steady_clock::now()
+        };
+
+        if (params.contains("responseHeaders"))
+        {
+            for (const auto& header : params["responseHeaders"])
+            {
+                interception.headers.emplace_back(header["name"], header["value"]);
+            }
+        }
+
+        const bool isLargeBody = GetContentLength(interception.headers) > StreamBodyThreshold;
+
+        // a document seen before under the same hooks is likely byte for byte the same, read it whole so the memo applies.
+        if (m_streamResponseBodies && isLargeBody && !this->WasPatchedBefore(interception.url))
+        {
+            this->StreamResponseBody(std::move(interception), std::move(*shimContent));
+        }
+        else
+        {
+            this->RequestResponseBody(std::move(interception));
+        }
+    }
+}
+
+bool WebkitHandler::WasPatchedBefore(const std::string& requestUrl)
+{
+    const std::string urlKey = fmt::format("{}:{}", this->GetCompiledHooks()->generation, requestUrl);
+
+    std::lock_guard<std::mutex> lock(m_patchedDocuments->mutex);
+    return m_patchedDocuments->seenUrls.Get(urlKey) != nullptr;
+}
+
+void WebkitHandler::MarkPatched(const std::string& requestUrl)
+{
+    const std::string urlKey = fmt::format("{}:{}", this->GetCompiledHooks()->generation, requestUrl);
+
+    std::lock_guard<std::mutex> lock(m_patchedDocuments->mutex);
+    m_patchedDocuments->seenUrls.Put(urlKey, true);
+}
+
+void WebkitHandler::RequestResponseBody(PendingInterceptions::Interception interception)
+{
+    hookMessageId -= 1;
+    interception.hookId = hookMessageId;
+
+    // hook ids count down from below zero so they never collide with the ids the CDP client hands out.
+    const CDP::Fetch::GetResponseBody getResponseBody { interception.requestId };
+    std::string payload = CDP::Serialize(hookMessageId, getResponseBody);
+
+    this->ExpireInterceptions();
+    m_pendingInterceptions->Insert(std::move(interception));
+
+    Sockets::PostPayload(std::move(payload), CDP::GetLaneForMethod(getResponseBody.method));
+}
+
+void WebkitHandler::StreamResponseBody(PendingInterceptions::Interception interception, std::string shimContent)
+{
+    auto stream = std::make_shared<BodyStream>();
+    stream->interception = std::move(interception);
+    stream->shimContent = std::move(shimContent);
+    m_streamsInFlight->fetch_add(1, std::memory_order_relaxed);
+
+    CDP::Client::InstanceRef().Send(CDP::Fetch::TakeResponseBodyAsStream { stream->interception.requestId }, [this, stream](const CDP::Message& response)
+    {
+        const auto streamHandle = response.FindString({ "result", "stream" });
+
+        if (response.HasError() || !streamHandle.has_value())
+        {
+            // the body hasn't been touched yet, so it can still be read in one go.
+            m_streamsInFlight->fetch_sub(1, std::memory_order_relaxed);
+            this->RequestResponseBody(std::move(stream->interception));
+            return;
+        }
+
+        stream->handle = *streamHandle;
+        this->ReadBodyChunk(stream);
+    });
+}
+
+void WebkitHandler::ReadBodyChunk(std::shared_ptr<BodyStream> stream)
+{
+    CDP::Client::InstanceRef().Send(CDP::IO::Read { stream->handle, std::nullopt, BodyChunkSize }, [this, stream](const CDP::Message& response)
+    {
+        try
+        {
+            if (response.HasError())
+            {
+                throw std::runtime_error("IO.read failed");
+            }
+
+            const auto dataView = response.FindString({ "result", "data" });
+            const std::string_view data = dataView.has_value() ? *dataView : std::string_view(response.Json()["result"]["data"].get_ref<const std::string&>());
+
+            if (response.FindBool({ "result", "base64Encoded" }).value_or(false))
+            {
+                const std::string decoded = Base64Decode(data);
+                this->AppendBodyChunk(*stream, decoded);
+            }
+            else
+            {
+                this->AppendBodyChunk(*stream, data);
+            }
+
+            if (response.FindBool({ "result", "eof" }).value_or(true))
+            {
+                this->FinishBodyStream(*stream);
+                return;
+            }
+
+            this->ReadBodyChunk(stream);
+        }
+        catch (const std::exception& ex)
+        {
+            // the body was already taken from the browser, the request can't be continued as is anymore.
+            LOG_ERROR("error streaming document body -> {}", ex.what());
+
+            CDP::Client::InstanceRef().Send(CDP::IO::Close { stream->handle });
+            CDP::Client::InstanceRef().Send(CDP::Fetch::FailRequest { stream->interception.requestId, "Failed" });
+            m_streamsInFlight->fetch_sub(1, std::memory_order_relaxed);
+        }
+    });
+}
+
+void WebkitHandler::AppendBodyChunk(BodyStream& stream, std::string_view chunk)
+{
+    if (stream.headPatched)
+    {
+        stream.encoder.Append(chunk);
+        return;
+    }
+
+    stream.pending.append(chunk);
+
+    const std::string_view pending = stream.pending;
+    const HeadInjector::Scan scan = HeadInjector::FindInsertionPoint(pending);
+
+    if (scan.insertAt != std::string_view::npos)
+    {
+        stream.encoder.Append(pending.substr(0, scan.insertAt));
+        stream.encoder.Append(stream.shimContent);
+        stream.encoder.Append(pending.substr(scan.insertAt));
+
+        stream.pending.clear();
+        stream.pending.shrink_to_fit();
+        stream.headPatched = true;
+        return;
+    }
+
+    // only hold back what could be a head tag that's split across two chunks.
+    stream.encoder.Append(pending.substr(0, scan.settled));
+    stream.pending.erase(0, scan.settled);
+}
+
+void WebkitHandler::FinishBodyStream(BodyStream& stream)
+{
+    stream.encoder.Append(stream.pending);
+    stream.encoder.Finish();
+
+    const auto& interception = stream.interception;
+    std::vector<CDP::Fetch::HeaderEntry> responseHeaders;
+    responseHeaders.reserve(interception.headers.size());
+
+    for (const auto& [name, value] : interception.headers)
+    {
+        responseHeaders.push_back({ name, value });
     }
+
+    CDP::Client::InstanceRef().Send(CDP::IO::Close { stream.handle });
+    CDP::Client::InstanceRef().Send(CDP::Fetch::FulfillRequest {
+        interception.requestId,
+        interception.statusCode,
+        std::move(responseHeaders),
+        stream.encodedBody,
+        interception.statusText.empty() ? std::string_view("OK") : std::string_view(interception.statusText)
+    });
+
+    this->MarkPatched(interception.url);
+    m_streamsInFlight->fetch_sub(1, std::memory_order_relaxed);
 }
 
-const std::string WebkitHandler::PatchDocumentContents(std::string requestUrl, std::string original) 
+std::optional<std::string> WebkitHandler::BuildShimContent(const std::string& requestUrl) 
 {
-    std::string patched = original;
-    const std::string webkitPreloadModule = SystemIO::ReadFileSync((SystemIO::GetInstallPath() / "ext" / "data" / "shims" / "webkit_api.js").string());
+    const auto webkitShimPrelude = GetWebkitShimPrelude();
 
-    if (webkitPreloadModule.empty()) 
+    if (!webkitShimPrelude || webkitShimPrelude->empty()) 
     {
         LOG_ERROR("Missing webkit preload module. Please re-install Millennium.");
         #ifdef _WIN32
         MessageBoxA(NULL, "Missing webkit preload module. Please re-install Millennium.", "Millennium", MB_ICONERROR);
         #endif
-        return patched;
+        return std::nullopt;
+    }
+
+    const auto compiledHooks = this->GetCompiledHooks();
+    {
+        std::lock_guard<std::mutex> lock(compiledHooks->cacheMutex);
+        const auto* cached = compiledHooks->shimCache.Get(requestUrl);
+
+        // the prelude is swapped out whenever webkit_api.js changes on disk.
+        if (cached && cached->prelude == webkitShimPrelude)
+        {
+            return cached->content;
+        }
     }
 
+    std::string shimContent = this->RenderShimContent(requestUrl, *compiledHooks, *webkitShimPrelude);
+
+    std::lock_guard<std::mutex> lock(compiledHooks->cacheMutex);
+    compiledHooks->shimCache.Put(requestUrl, { webkitShimPrelude, shimContent });
+    return shimContent;
+}
+
+std::string WebkitHandler::RenderShimContent(const std::string& requestUrl, CompiledHooks& compiledHooks, const std::string& webkitShimPrelude)
+{
     std::vector<std::string> scriptModules;
     std::string cssShimContent, scriptModuleArray;
 
-    for (auto& hookItem : *m_hookListPtr) 
+    for (const std::size_t hookIndex : compiledHooks.Match(requestUrl)) 
     {
+        const HookType& hookItem = compiledHooks.hooks[hookIndex];
+
         if (hookItem.type == TagTypes::STYLESHEET) 
         {
-            if (!std::regex_match(requestUrl, hookItem.urlPattern)) 
-                continue;
-
             std::filesystem::path relativePath = std::filesystem::relative(hookItem.path, SystemIO::GetSteamPath() / "steamui");
             cssShimContent.append(fmt::format("<link rel=\"stylesheet\" href=\"{}{}\">\n", this->m_steamLoopback, relativePath.generic_string())); 
         }
         else if (hookItem.type == TagTypes::JAVASCRIPT) 
         {
-            if (!std::regex_match(requestUrl, hookItem.urlPattern)) 
-                continue;
-            
             std::filesystem::path relativePath = std::filesystem::relative(hookItem.path, SystemIO::GetSteamPath());
-            scriptModules.push_back(fmt::format("{}{}", this->m_javaScriptVirtualUrl, relativePath.generic_string()));
+            std::string scriptModule = fmt::format("{}{}", this->m_javaScriptVirtualUrl, relativePath.generic_string());
+
+            // a module hooked under several patterns that all match is still only imported once.
+            if (std::find(scriptModules.begin(), scriptModules.end(), scriptModule) == scriptModules.end())
+            {
+                scriptModules.push_back(std::move(scriptModule));
+            }
         }
     }
 
@@ -154,84 +551,179 @@ const std::string WebkitHandler::PatchDocumentContents(std::string requestUrl, s
         scriptModuleArray.append(fmt::format("\"{}\"{}", scriptModules[i], (i == scriptModules.size() - 1 ? "" : ",")));
     }
 
-    std::string shimContent = fmt::format("<script type=\"module\" id=\"millennium-injected\" defer>{}millennium_components({}, [{}])\n</script>\n{}", webkitPreloadModule, m_ipcPort, scriptModuleArray, cssShimContent);
+    if (GetBlackListMatcher().MatchesAny(requestUrl)) 
+    {
+        return cssShimContent; // Remove all queried JavaScript from the page. 
+    }
+
+    if (scriptModules.empty() && cssShimContent.empty())
+    {
+        return std::string(); // no hook wants this document.
+    }
+
+    std::string shimContent;
 
-    for (const auto& blackListedUrl : g_blackListedUrls)        
+    // start fetching every module right away, rather than one by one once the shim gets to importing them.
+    if (m_preloadModules)
     {
-        if (std::regex_match(requestUrl, std::regex(blackListedUrl))) 
+        for (const auto& scriptModule : scriptModules)
         {
-            shimContent = cssShimContent; // Remove all queried JavaScript from the page. 
+            shimContent.append(fmt::format("<link rel=\"modulepreload\" href=\"{}\">\n", scriptModule));
         }
     }
 
-    if (patched.find("<head>") == std::string::npos) 
+    shimContent.append(webkitShimPrelude);
+    shimContent.append(fmt::format("{}, [{}])\n</script>\n{}", m_ipcPort, scriptModuleArray, cssShimContent));
+    return shimContent;
+}
+
+std::string WebkitHandler::EncodePatchedDocument(const std::string& requestUrl, std::string_view original) 
+{
+    const auto shimContent = this->BuildShimContent(requestUrl);
+    const std::size_t insertAt = shimContent.has_value() ? HeadInjector::FindInsertionPoint(original).insertAt : std::string_view::npos;
+
+    std::string encoded;
+    encoded.reserve(Base64EncodedSize(original.size() + (shimContent.has_value() ? shimContent->size() : 0)));
+
+    // the patched document is never put together, its pieces are encoded straight into the response body.
+    Base64StreamEncoder encoder(encoded);
+
+    if (insertAt == std::string_view::npos)
     {
-        return patched;
+        encoder.Append(original);
+    }
+    else
+    {
+        encoder.Append(original.substr(0, insertAt));
+        encoder.Append(*shimContent);
+        encoder.Append(original.substr(insertAt));
     }
 
-    return patched.replace(patched.find("<head>"), 6, "<head>" + shimContent);
+    encoder.Finish();
+    return encoded;
 }
 
-void WebkitHandler::HandleHooks(nlohmann::basic_json<> message)
+void WebkitHandler::ExpireInterceptions()
 {
-    for (auto requestIterator = m_requestMap->begin(); requestIterator != m_requestMap->end();)
+    const auto now = std::chrono::steady_clock::now();
+
+    if (now - m_lastExpiry < std::chrono::seconds(5))
     {
-        try 
-        {
-            auto [id, requestId, type, response] = (*requestIterator);
+        return;
+    }
 
-            if (message["id"] != id || (message["id"] == id && !message["result"]["base64Encoded"]))
-            {
-                requestIterator++;
-                continue;
-            }
+    m_lastExpiry = now;
+    const auto expired = m_pendingInterceptions->Expire(std::chrono::seconds(30));
+
+    if (expired.empty())
+    {
+        return;
+    }
+
+    Logger.Warn("Giving up on hooking {} document(s) whose body never arrived, loading them unpatched.", expired.size());
 
-            const std::string patchedContent = this->PatchDocumentContents(response["params"]["request"]["url"], Base64Decode(message["result"]["body"]));
+    // a late body finds no entry and is ignored, so release the requests here or they stay paused for good.
+    for (const auto& interception : expired)
+    {
+        CDP::Client::InstanceRef().Send(CDP::Fetch::ContinueRequest { interception.requestId });
+    }
+}
+
+void WebkitHandler::HandleHooks(const CDP::Message& message)
+{
+    // bodies are requested with negative ids, anything else was never ours.
+    if (!message.HasId() || message.Id() >= 0)
+    {
+        return;
+    }
+
+    const auto interception = m_pendingInterceptions->Take(message.Id());
+
+    if (!interception.has_value())
+    {
+        return;
+    }
+
+    try 
+    {
+        if (message.HasError())
+        {
+            // don't leave the page hanging, let it load without our hooks.
+            CDP::Client::InstanceRef().Send(CDP::Fetch::ContinueRequest { interception->requestId });
+            return;
+        }
 
-            BypassCSP();
+        // the body is read as a view into the receive buffer, it's only copied once it has been decoded.
+        const auto bodyView = message.FindString({ "result", "body" });
+        const std::string_view body = bodyView.has_value() ? *bodyView : std::string_view(message.Json()["result"]["body"].get_ref<const std::string&>());
+        const bool base64Encoded = message.FindBool({ "result", "base64Encoded" }).value_or(false);
 
-            const int responseCode = response["params"].value("responseStatusCode", 200);
-            const std::string responseMessage = response["params"].value("responseStatusText", "OK");
+        // pages like the library or settings come back byte for byte the same every time they're opened.
+        const auto compiledHooks = this->GetCompiledHooks();
+        const auto webkitShimPrelude = GetWebkitShimPrelude();
+        const std::string documentKey = fmt::format("{}:{}:{:x}:{:x}:{}", compiledHooks->generation, base64Encoded, HashContents(body), body.size(), interception->url);
 
-            Sockets::PostGlobal({
-                { "id", 63453 },
-                { "method", "Fetch.fulfillRequest" },
-                { "params", {
-                    { "requestId", requestId },
-                    { "responseCode", responseCode },
-                    { "responseHeaders", response["params"]["responseHeaders"] },
-                    { "responsePhrase", responseMessage.length() > 0 ? responseMessage : "OK" },
-                    { "body", Base64Encode(patchedContent) }
-                }}
-            });
+        std::shared_ptr<const std::string> encodedBody;
+        {
+            std::lock_guard<std::mutex> lock(m_patchedDocuments->mutex);
+            const auto* cached = m_patchedDocuments->documents.Get(documentKey);
 
-            requestIterator = m_requestMap->erase(requestIterator);
+            if (cached && cached->prelude == webkitShimPrelude)
+            {
+                encodedBody = cached->encodedBody;
+            }
         }
-        catch (const nlohmann::detail::exception& ex) 
+
+        if (!encodedBody)
         {
-            LOG_ERROR("error hooking WebKit -> {}\n\n{}", ex.what(), message.dump(4));
-            requestIterator = m_requestMap->erase(requestIterator);
+            const std::string decodedBody = base64Encoded ? Base64Decode(body) : std::string();
+            encodedBody = std::make_shared<const std::string>(this->EncodePatchedDocument(interception->url, base64Encoded ? std::string_view(decodedBody) : body));
+
+            std::lock_guard<std::mutex> lock(m_patchedDocuments->mutex);
+            m_patchedDocuments->documents.Put(documentKey, { webkitShimPrelude, encodedBody }, encodedBody->size());
+            m_patchedDocuments->seenUrls.Put(fmt::format("{}:{}", compiledHooks->generation, interception->url), true);
         }
-        catch (const std::exception& ex) 
+
+        std::vector<CDP::Fetch::HeaderEntry> responseHeaders;
+        responseHeaders.reserve(interception->headers.size());
+
+        for (const auto& [name, value] : interception->headers)
         {
-            LOG_ERROR("error hooking WebKit -> {}\n\n{}", ex.what(), message.dump(4));
-            requestIterator = m_requestMap->erase(requestIterator);
+            responseHeaders.push_back({ name, value });
         }
+
+        CDP::Client::InstanceRef().Send(CDP::Fetch::FulfillRequest {
+            interception->requestId,
+            interception->statusCode,
+            std::move(responseHeaders),
+            *encodedBody,
+            interception->statusText.empty() ? std::string_view("OK") : std::string_view(interception->statusText)
+        });
+    }
+    catch (const nlohmann::detail::exception& ex) 
+    {
+        LOG_ERROR("error hooking WebKit -> {} (message id {})", ex.what(), message.Id());
+    }
+    catch (const std::exception& ex) 
+    {
+        LOG_ERROR("error hooking WebKit -> {} (message id {})", ex.what(), message.Id());
     }
 }
 
-void WebkitHandler::DispatchSocketMessage(nlohmann::basic_json<> message)
+void WebkitHandler::DispatchSocketMessage(const CDP::Message& message)
 {
     static std::chrono::time_point lastExceptionTime = std::chrono::system_clock::now();
 
     try 
     {
-        if (message["method"] == "Fetch.requestPaused")
+        if (CDP::ParseMethod(message.Method()) == CDP::Method::Fetch_requestPaused)
         {
-            switch (this->IsGetBodyCall(message))
+            const auto& json = message.Json();
+
+            switch (this->IsGetBodyCall(json))
             {
-                case true:  { this->RetrieveRequestFromDisk(message); break; }
-                case false: { this->GetResponseBody(message);         break; }
+                case true:  { this->RetrieveRequestFromDisk(json); break; }
+                case false: { this->GetResponseBody(json);         break; }
             }
         }
 
@@ -4,8 +4,13 @@
 #include <vector>
 #include <mutex>
 #include <regex>
-
-extern unsigned long long g_hookedModuleId;
+#include <core/cdp/message.h>
+#include <core/hooks/interceptions.h>
+#include <core/hooks/hook_matcher.h>
+#include <sys/lru_cache.h>
+#include <sys/encoding.h>
+#include <optional>
+#include <atomic>
 
 class WebkitHandler 
 {
@@ -19,7 +24,7 @@ public:
 
     struct HookType {
         std::string path;
-        std::regex urlPattern;
+        HookMatcher::Pattern urlPattern;
         TagTypes type;
         unsigned long long id;
     };
@@ -32,11 +37,18 @@ public:
         PERMANENT_REDIRECT = 308
     };
 
-    std::shared_ptr<std::vector<HookType>> m_hookListPtr = std::make_shared<std::vector<HookType>>();
+    /// @brief inject a module into documents whose url matches urlPattern.
+    /// @throws std::regex_error if urlPattern isn't a valid regex.
+    /// @return the id of the hook, to remove it with.
+    unsigned long long AddHook(std::string path, const std::string& urlPattern, TagTypes type);
+    bool RemoveHook(unsigned long long hookId);
 
-    void DispatchSocketMessage(nlohmann::basic_json<> message);
+    void DispatchSocketMessage(const CDP::Message& message);
     void SetupGlobalHooks();
 
+    /// @brief documents waiting on their body before they can be patched.
+    std::size_t InFlightInterceptions() const { return m_pendingInterceptions->InFlight() + m_streamsInFlight->load(std::memory_order_relaxed); }
+
     void SetIPCPort(uint16_t ipcPort) { m_ipcPort = ipcPort; }
 
 private:
@@ -47,25 +59,101 @@ private:
     const char* m_javaScriptVirtualUrl = "https://pseudo.millennium.app/";
     const char* m_steamLoopback = "https://steamloopback.host/";
 
-    bool IsGetBodyCall(nlohmann::basic_json<> message);
+    bool IsGetBodyCall(const nlohmann::json& message);
 
     std::string HandleCssHook(std::string body);
     std::string HandleJsHook(std::string body);
 
-    const std::string PatchDocumentContents(std::string requestUrl, std::string original);
-    void HandleHooks(nlohmann::basic_json<> message);
+    std::optional<std::string> BuildShimContent(const std::string& requestUrl);
+    /// @return the document with the shim injected after its <head> tag, base64 encoded for Fetch.fulfillRequest.
+    std::string EncodePatchedDocument(const std::string& requestUrl, std::string_view original);
+    void HandleHooks(const CDP::Message& message);
+    void ExpireInterceptions();
+
+    void RetrieveRequestFromDisk(const nlohmann::json& message);
+    void GetResponseBody(const nlohmann::json& message);
+    void RequestResponseBody(PendingInterceptions::Interception interception);
+
+    /* a document body read in chunks with IO.read, encoded for Fetch.fulfillRequest as it arrives. */
+    struct BodyStream {
+        PendingInterceptions::Interception interception;
+        std::string handle;
+        std::string shimContent;
+
+        bool headPatched = false;
+        std::string pending; // tail of the document that may hold the start of a split "<head>"
 
-    void RetrieveRequestFromDisk(nlohmann::basic_json<> message);
-    void GetResponseBody(nlohmann::basic_json<> message);
+        std::string encodedBody;
+        Base64StreamEncoder encoder { encodedBody };
+    };
+
+    static constexpr long long BodyChunkSize = 256 * 1024;
+    /* below this (or without a Content-Length) a document is read in one go, one round trip beats several IO.read calls. */
+    static constexpr unsigned long long StreamBodyThreshold = 1024 * 1024;
+    bool m_streamResponseBodies = true;
+    bool m_preloadModules = true;
+    std::shared_ptr<std::atomic<std::size_t>> m_streamsInFlight = std::make_shared<std::atomic<std::size_t>>(0);
+
+    void StreamResponseBody(PendingInterceptions::Interception interception, std::string shimContent);
+    void ReadBodyChunk(std::shared_ptr<BodyStream> stream);
+    void AppendBodyChunk(BodyStream& stream, std::string_view chunk);
+    void FinishBodyStream(BodyStream& stream);
 
     std::filesystem::path ConvertToLoopBack(std::string requestUrl);
 
-    struct WebHookItem {
-        long long id;
-        std::string requestId;
-        std::string type;
-        nlohmann::basic_json<> message;
+    /* an immutable snapshot of the hooks, compiled into a single matcher. */
+    struct CompiledHooks {
+        unsigned long long generation;
+        std::vector<HookType> hooks;
+        HookMatcher matcher;
+
+        struct CachedShim {
+            std::shared_ptr<const std::string> prelude;
+            std::string content;
+        };
+
+        std::mutex cacheMutex;
+        LruCache<std::string, std::vector<std::size_t>> matchCache { 256 };
+        LruCache<std::string, CachedShim> shimCache { 256 };
+
+        /// @return indices into hooks, in the order they were added.
+        std::vector<std::size_t> Match(const std::string& url);
+    };
+
+    struct HookRegistry {
+        std::mutex mutex;
+        std::vector<HookType> hooks;
+        unsigned long long generation = 0;
+        std::shared_ptr<CompiledHooks> compiled;
+
+        bool fetchEnabled = false;
+        std::vector<std::string> fetchPatterns; // the document patterns Fetch was last enabled with
+    };
+
+    std::shared_ptr<CompiledHooks> GetCompiledHooks();
+    std::string RenderShimContent(const std::string& requestUrl, CompiledHooks& compiledHooks, const std::string& webkitShimPrelude);
+
+    /* patched & encoded documents, keyed by hook generation, 64-bit body hash, body length and url, bounded by their encoded size. */
+    struct PatchedDocuments {
+        struct Document {
+            std::shared_ptr<const std::string> prelude;
+            std::shared_ptr<const std::string> encodedBody;
+        };
+
+        std::mutex mutex;
+        LruCache<std::string, Document> documents { 64 * 1024 * 1024 };
+        LruCache<std::string, bool> seenUrls { 256 }; // "generation:url" of documents patched before, read whole from then on
     };
 
-    std::shared_ptr<std::vector<WebHookItem>> m_requestMap = std::make_shared<std::vector<WebHookItem>>();
-};
\ No newline at end of file
+    /// @return whether `requestUrl` was patched under the current hooks, i.e reading it whole may hit the memo.
+    bool WasPatchedBefore(const std::string& requestUrl);
+    void MarkPatched(const std::string& requestUrl);
+
+    /// @brief re-enable Fetch with document patterns derived from the hooks, if they changed or `force` is set.
+    void UpdateFetchPatterns(bool force);
+
+    std::shared_ptr<HookRegistry> m_hookRegistry = std::make_shared<HookRegistry>();
+    std::chrono::steady_clock::time_point m_lastExpiry;
+    std::shared_ptr<PendingInterceptions> m_pendingInterceptions = std::make_shared<PendingInterceptions>();
+    std::shared_ptr<PatchedDocuments> m_patchedDocuments = std::make_shared<PatchedDocuments>();
+};
\ No newline at end of file
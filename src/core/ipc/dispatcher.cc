@@ -0,0 +1,132 @@
+#include "dispatcher.h"
+#include <algorithm>
+#include <sys/log.h>
+#include <core/py_controller/co_spawn.h>
+
+/* a backlog this deep means the plugin isn't keeping up, it's reported every time it grows by this much. */
+static constexpr std::size_t QueueDepthWarning = 32;
+
+void IPCMain::Dispatcher::Submit(const std::string& pluginName, Job job)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_stopping)
+    {
+        return;
+    }
+
+    PluginQueue& queue = m_queues[pluginName];
+    queue.jobs.push_back(std::move(job));
+
+    if (queue.jobs.size() >= queue.warnedDepth + QueueDepthWarning)
+    {
+        queue.warnedDepth = queue.jobs.size();
+        Logger.Warn("{} has {} IPC requests waiting on it, its backend is falling behind.", pluginName, queue.jobs.size());
+    }
+
+    // the map's nodes never move, so a worker can hold on to its queue.
+    if (queue.idle == 0 && queue.workers.size() < m_concurrencyLimit)
+    {
+        queue.workers.emplace_back(&Dispatcher::Work, this, pluginName, std::ref(queue));
+    }
+    queue.jobAdded.notify_one();
+}
+
+void IPCMain::Dispatcher::Work(const std::string& pluginName, PluginQueue& queue)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        queue.idle++;
+        queue.jobAdded.wait(lock, [this, &queue] { return m_stopping || !queue.jobs.empty(); });
+        queue.idle--;
+
+        if (m_stopping)
+        {
+            return;
+        }
+
+        Job job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+        queue.running++;
+
+        if (queue.jobs.empty())
+        {
+            queue.warnedDepth = 0;
+        }
+
+        lock.unlock();
+
+        try
+        {
+            job();
+        }
+        catch (const std::exception& ex)
+        {
+            LOG_ERROR("uncaught error handling IPC request for {} -> {}", pluginName, ex.what());
+        }
+
+        lock.lock();
+        queue.running--;
+        queue.completed++;
+    }
+}
+
+IPCMain::Dispatcher::~Dispatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+
+        for (auto& [pluginName, queue] : m_queues)
+        {
+            queue.jobs.clear();
+            queue.jobAdded.notify_all();
+        }
+    }
+
+    // requests already running are let finish, nothing new is picked up.
+    for (auto& [pluginName, queue] : m_queues)
+    {
+        for (auto& worker : queue.workers)
+        {
+            worker.join();
+        }
+    }
+}
+
+void IPCMain::Dispatcher::SetConcurrencyLimit(std::size_t concurrencyLimit)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_concurrencyLimit = std::max<std::size_t>(concurrencyLimit, 1);
+}
+
+std::vector<IPCMain::Dispatcher::Gauge> IPCMain::Dispatcher::Gauges()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Gauge> gauges;
+    gauges.reserve(m_queues.size());
+
+    for (const auto& [pluginName, queue] : m_queues)
+    {
+        gauges.push_back({ pluginName, queue.jobs.size(), queue.running, queue.completed });
+    }
+
+    // calls made once a plugin has loaded are queued on its own thread, count those against the same plugin.
+    for (const auto& executor : PythonManager::GetInstance().ExecutorGauges())
+    {
+        auto gauge = std::find_if(gauges.begin(), gauges.end(), [&executor](const Gauge& gauge) { return gauge.pluginName == executor.pluginName; });
+
+        if (gauge == gauges.end())
+        {
+            gauges.push_back({ executor.pluginName, executor.queued, executor.running, executor.completed });
+            continue;
+        }
+
+        gauge->queued += executor.queued;
+        gauge->running += executor.running;
+        gauge->completed += executor.completed;
+    }
+    return gauges;
+}
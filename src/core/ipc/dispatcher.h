@@ -0,0 +1,76 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+
+namespace IPCMain
+{
+    /**
+     * Runs IPC requests off the socket thread, on workers that belong to the plugin a request is for. A slow backend
+     * method only holds up calls to its own plugin, and each plugin runs at most `concurrencyLimit` requests at a
+     * time, so with the default of one a plugin still sees its calls in the order they were made.
+     *
+     * Once a plugin's backend has loaded, calls into it are queued on its own thread instead (see PostToBackend in
+     * pipe.cc), what's left here are calls made during _load and requests that only touch the frontend. That's also all
+     * `concurrencyLimit` applies to, a loaded plugin's own thread runs its calls one at a time.
+     *
+     * A plugin's workers are started the first time it's sent a request and wait on its queue from then on, so they
+     * keep the thread state they entered its interpreter with. They're joined when the dispatcher is destroyed, requests
+     * still queued at that point are dropped.
+     */
+    class Dispatcher
+    {
+    public:
+        using Job = std::function<void()>;
+
+        struct Gauge
+        {
+            std::string pluginName;
+            std::size_t queued;
+            std::size_t running;
+            unsigned long long completed;
+        };
+
+        static Dispatcher& InstanceRef()
+        {
+            static Dispatcher instance;
+            return instance;
+        }
+
+        Dispatcher(const Dispatcher&) = delete;
+        Dispatcher& operator=(const Dispatcher&) = delete;
+
+        void Submit(const std::string& pluginName, Job job);
+        void SetConcurrencyLimit(std::size_t concurrencyLimit);
+
+        /// @return the queue depth of every plugin that has been sent a request, here and on its own thread's queue.
+        std::vector<Gauge> Gauges();
+
+    private:
+        Dispatcher() {}
+        ~Dispatcher();
+
+        struct PluginQueue
+        {
+            std::deque<Job> jobs;
+            std::condition_variable jobAdded;
+            std::vector<std::thread> workers;
+            std::size_t idle = 0;
+            std::size_t running = 0;
+            unsigned long long completed = 0;
+            std::size_t warnedDepth = 0;
+        };
+
+        void Work(const std::string& pluginName, PluginQueue& queue);
+
+        std::mutex m_mutex;
+        bool m_stopping = false;
+        std::size_t m_concurrencyLimit = 1;
+        std::unordered_map<std::string, PluginQueue> m_queues;
+    };
+}
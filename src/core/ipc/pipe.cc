@@ -5,22 +5,15 @@
 #include <core/ffi/ffi.h>
 #include <sys/encoding.h>
 #include <core/ipc/pipe.h>
+#include <core/ipc/dispatcher.h>
+#include <sys/locals.h>
 #include <functional>
 #include <sys/asio.h>
 
 typedef websocketpp::server<websocketpp::config::asio> socketServer;
 
-static nlohmann::json CallServerMethod(nlohmann::basic_json<> message)
+static nlohmann::json MakeServerMethodResponse(const nlohmann::json& iteration, Python::EvalResult response)
 {
-    const std::string fnCallScript = Python::ConstructFunctionCall(message["data"]);
-
-    if (!message["data"].contains("pluginName")) 
-    {
-        LOG_ERROR("no plugin backend specified, doing nothing...");
-        return {};
-    }
-
-    Python::EvalResult response = Python::LockGILAndEvaluate(message["data"]["pluginName"], fnCallScript);
     nlohmann::json responseMessage;
 
     switch (response.type)
@@ -28,6 +21,7 @@ static nlohmann::json CallServerMethod(nlohmann::basic_json<> message)
         case Python::Types::Boolean: { responseMessage["returnValue"] = (response.plain == "True" ? true : false); break; }
         case Python::Types::String:  { responseMessage["returnValue"] = Base64Encode(response.plain);              break; }
         case Python::Types::Integer: { responseMessage["returnValue"] = stoi(response.plain);                      break; }
+        case Python::Types::Unknown: { responseMessage["returnValue"] = std::move(response.json);                  break; }
 
         case Python::Types::Error: 
         {
@@ -37,20 +31,67 @@ static nlohmann::json CallServerMethod(nlohmann::basic_json<> message)
         }
     }
 
-    responseMessage["id"] = message["iteration"];
+    responseMessage["id"] = iteration;
     return responseMessage; 
 }
 
-static nlohmann::json OnFrontEndLoaded(nlohmann::basic_json<> message)
+static nlohmann::json CallServerMethod(nlohmann::basic_json<> message)
 {
-    Python::LockGILAndDiscardEvaluate(message["data"]["pluginName"], "plugin._front_end_loaded()");
+    if (!message["data"].contains("pluginName")) 
+    {
+        LOG_ERROR("no plugin backend specified, doing nothing...");
+        return {};
+    }
+
+    return MakeServerMethodResponse(message["iteration"], Python::LockGILAndInvokeMethod(message["data"]["pluginName"], message["data"]));
+}
 
+static nlohmann::json MakeFrontEndLoadedResponse(const nlohmann::json& iteration)
+{
     return nlohmann::json({
-        { "id", message["iteration"] },
+        { "id", iteration },
         { "success", true }
     });
 }
 
+static nlohmann::json OnFrontEndLoaded(nlohmann::basic_json<> message)
+{
+    Python::LockGILAndDiscardEvaluate(message["data"]["pluginName"], "plugin._front_end_loaded()");
+    return MakeFrontEndLoadedResponse(message["iteration"]);
+}
+
+/**
+ * Once a plugin's backend has loaded, calls into it are queued on its own thread and answered from there when they
+ * return, no thread is left waiting on them. While a backend method waits on the frontend, that thread keeps taking
+ * calls, so the frontend can call back into the plugin before it answers.
+ *
+ * @return false if the backend isn't taking calls yet, or the message doesn't call into it.
+ */
+static bool PostToBackend(socketServer::connection_ptr serverConnection, websocketpp::frame::opcode::value opcode, const std::string& pluginName, const nlohmann::json& message)
+{
+    const auto respond = [serverConnection, opcode](const nlohmann::json& response) { serverConnection->send(response.dump(), opcode); };
+    const nlohmann::json iteration = message.value("iteration", nlohmann::json());
+
+    switch (message.at("id").get<int>())
+    {
+        case IPCMain::Builtins::CALL_SERVER_METHOD:
+        {
+            return Python::InvokeMethodAsync(pluginName, message.at("data"), [respond, iteration](Python::EvalResult response) 
+            { 
+                respond(MakeServerMethodResponse(iteration, std::move(response))); 
+            });
+        }
+        case IPCMain::Builtins::FRONT_END_LOADED:
+        {
+            return Python::DiscardEvaluateAsync(pluginName, "plugin._front_end_loaded()", [respond, iteration] 
+            { 
+                respond(MakeFrontEndLoadedResponse(iteration)); 
+            });
+        }
+    }
+    return false;
+}
+
 static nlohmann::json GetFrontendSettings(nlohmann::basic_json<> message)
 {
     const std::string pluginName = message["data"]["pluginName"];
@@ -64,42 +105,63 @@ static nlohmann::json GetFrontendSettings(nlohmann::basic_json<> message)
     });
 }
 
+static std::string HandleMessage(nlohmann::json message)
+{
+    try
+    {
+        switch (message["id"].get<int>()) 
+        {
+            case IPCMain::Builtins::CALL_SERVER_METHOD:    { return CallServerMethod(message).dump();    }
+            case IPCMain::Builtins::FRONT_END_LOADED:      { return OnFrontEndLoaded(message).dump();    }
+            case IPCMain::Builtins::GET_FRONTEND_SETTINGS: { return GetFrontendSettings(message).dump(); }
+        }
+        return {};
+    }
+    catch (nlohmann::detail::exception& ex) 
+    {
+        return std::string(ex.what());
+    }
+    catch (std::exception& ex) 
+    {
+        return std::string(ex.what());
+    }
+}
+
 void OnMessage(socketServer* serv, websocketpp::connection_hdl hdl, socketServer::message_ptr msg)
 {
     socketServer::connection_ptr serverConnection = serv->get_con_from_hdl(hdl);
+    const auto opcode = msg->get_opcode();
 
     try
     {
         auto json_data = nlohmann::json::parse(msg->get_payload());
-        std::string responseMessage;
+        const auto pluginName = json_data.contains("data") ? json_data["data"].value("pluginName", std::string()) : std::string();
+
+        if (pluginName.empty())
+        {
+            serverConnection->send(HandleMessage(std::move(json_data)), opcode);
+            return;
+        }
 
-        switch (json_data["id"].get<int>()) 
+        if (PostToBackend(serverConnection, opcode, pluginName, json_data))
         {
-            case IPCMain::Builtins::CALL_SERVER_METHOD: 
-            {
-                responseMessage = CallServerMethod(json_data).dump(); 
-                break;
-            }
-            case IPCMain::Builtins::FRONT_END_LOADED: 
-            {
-                responseMessage = OnFrontEndLoaded(json_data).dump(); 
-                break;
-            }
-            case IPCMain::Builtins::GET_FRONTEND_SETTINGS:
-            {
-                responseMessage = GetFrontendSettings(json_data).dump();
-                break;
-            }
+            return;
         }
-        serverConnection->send(responseMessage, msg->get_opcode());
+
+        // everything else (i.e calls made while the backend is still in _load) is handled on the plugin's dispatcher worker.
+        // the response carries the request's iteration so it may go out of order.
+        IPCMain::Dispatcher::InstanceRef().Submit(pluginName, [serverConnection, opcode, message = std::move(json_data)]() mutable
+        {
+            serverConnection->send(HandleMessage(std::move(message)), opcode);
+        });
     }
     catch (nlohmann::detail::exception& ex) 
     {
-        serverConnection->send(std::string(ex.what()), msg->get_opcode());
+        serverConnection->send(std::string(ex.what()), opcode);
     }
     catch (std::exception& ex) 
     {
-        serverConnection->send(std::string(ex.what()), msg->get_opcode());
+        serverConnection->send(std::string(ex.what()), opcode);
     }
 }
 
@@ -136,6 +198,10 @@ const int OpenIPCSocket(uint16_t ipcPort)
 
 const uint16_t IPCMain::OpenConnection()
 {
+    // only covers calls that reach the dispatcher, i.e those made before a plugin's _load returns.
+    const std::string concurrencyLimit = SettingsStore().GetSetting("ipc_plugin_concurrency", "1");
+    IPCMain::Dispatcher::InstanceRef().SetConcurrencyLimit(std::strtoul(concurrencyLimit.c_str(), nullptr, 10));
+
     uint16_t ipcPort = Asio::GetRandomOpenPort();
     std::thread(OpenIPCSocket, ipcPort).detach();
     return ipcPort;
@@ -9,52 +9,30 @@
 #include <core/ffi/ffi.h>
 #include <sys/http.h>
 #include <core/hooks/web_load.h>
+#include <core/cdp/client.h>
 #include <sys/log.h>
 
 using namespace std::placeholders;
 using namespace std::chrono;
-websocketpp::client<websocketpp::config::asio_client>*browserClient;
-websocketpp::connection_hdl browserHandle;
 
+std::mutex sharedJsContextMutex;
 std::string sharedJsContextSessionId;
 std::shared_ptr<InterpreterMutex> g_threadTerminateFlag = std::make_shared<InterpreterMutex>();
 
-bool Sockets::PostShared(nlohmann::json data) 
+std::string Sockets::GetSharedSessionId()
 {
-    if (sharedJsContextSessionId.empty()) 
-    {
-        return false;
-    }
-
-    data["sessionId"] = sharedJsContextSessionId;
-    return Sockets::PostGlobal(data);
+    std::lock_guard<std::mutex> lock(sharedJsContextMutex);
+    return sharedJsContextSessionId;
 }
 
-bool Sockets::PostGlobal(nlohmann::json data) 
+bool Sockets::PostPayload(std::string payload, CDP::Lane lane, long long messageId)
 {
-    if (browserClient == nullptr) 
-    {
-        return false;
-    }
-
-    browserClient->send(browserHandle, data.dump(), websocketpp::frame::opcode::text);
-    return true;
+    return CDP::SendQueue::InstanceRef().Enqueue(std::move(payload), lane, messageId);
 }
 
 void Sockets::Shutdown() 
 {
-    try
-    {
-        if (browserClient != nullptr) 
-        {
-            browserClient->close(browserHandle, websocketpp::close::status::normal, "Shutting down");
-        }
-    }
-    catch(const websocketpp::exception& e)
-    {
-        LOG_ERROR("Failed to close browser connection: {}", e.what());
-    }
-    
+    CDP::SendQueue::InstanceRef().Close("Shutting down");
 }
 
 class CEFBrowser
@@ -63,16 +41,17 @@ class CEFBrowser
     uint16_t m_ftpPort, m_ipcPort;
     bool m_sharedJsConnected = false;
 
+    unsigned long long m_attachedSubscriberId, m_detachedSubscriberId, m_consoleSubscriberId;
     std::chrono::system_clock::time_point m_startTime;
 public:
 
-    const void HandleConsoleMessage(const nlohmann::json& json)
+    const void HandleConsoleMessage(const CDP::Message& message)
     {
         try
         {
-            if (json["params"]["message"]["level"] == "error")
+            if (message.FindString({ "params", "message", "level" }) == "error")
             {
-                const auto data = json["params"]["message"];
+                const auto data = message.Json()["params"]["message"];
 
                 std::string traceMessage = fmt::format("{}:{}:{}", data["url"].get<std::string>(), data["line"].get<int>(), data["column"].get<int>());
                 Logger.Warn("(Steam-Error) {}\n  Info: (This warning may be non-fatal)\n  Where: ({})", data["text"].get<std::string>(), traceMessage);
@@ -81,50 +60,75 @@ public:
         catch (const std::exception& e) { }
     }
 
-    const void onMessage(websocketpp::client<websocketpp::config::asio_client>* c, websocketpp::connection_hdl hdl, websocketpp::config::asio_client::message_type::ptr msg)
+    const void HandleAttachedToTarget(const CDP::Message& message)
     {
-        const auto json = nlohmann::json::parse(msg->get_payload());
-        const std::string method = json.value("method", std::string());
-        
-        if (json.contains("id") && json["id"] == 0 && 
-            json.contains("result") && json["result"].is_object() && 
-            json["result"].contains("targetInfos") && json["result"]["targetInfos"].is_array()) 
-        { 
-            const auto targets = json["result"]["targetInfos"];
-            auto targetIterator = std::find_if(targets.begin(), targets.end(), [](const auto& target) { return target["title"] == "SharedJSContext"; });
-            
-            if (targetIterator != targets.end() && !m_sharedJsConnected) 
-            {
-                Sockets::PostGlobal({ { "id", 0 }, { "method", "Target.attachToTarget" }, 
-                    { "params", { { "targetId", (*targetIterator)["targetId"] }, { "flatten", true } } } 
-                });
-                m_sharedJsConnected = true;
-            }
-            else if (!m_sharedJsConnected)
+        const auto& json = message.Json();
+
+        if (json["params"]["targetInfo"]["title"] == "SharedJSContext")
+        {
             {
-                this->SetupSharedJSContext();
+                std::lock_guard<std::mutex> lock(sharedJsContextMutex);
+                sharedJsContextSessionId = json["params"]["sessionId"];
             }
-        }
-        
-        if (method == "Target.attachedToTarget" && json["params"]["targetInfo"]["title"] == "SharedJSContext")
-        {
-            sharedJsContextSessionId = json["params"]["sessionId"];
             this->onSharedJsConnect();
         }
-        else if (method == "Console.messageAdded") 
+    }
+
+    const void HandleDetachedFromTarget(const CDP::Message& message)
+    {
+        const std::string sessionId = message.Json()["params"]["sessionId"];
         {
-            this->HandleConsoleMessage(json);
+            std::lock_guard<std::mutex> lock(sharedJsContextMutex);
+
+            if (sessionId != sharedJsContextSessionId)
+            {
+                return;
+            }
+            sharedJsContextSessionId.clear();
         }
-        else
-        {        
-            JavaScript::SharedJSMessageEmitter::InstanceRef().EmitMessage("msg", json);
+
+        Logger.Warn("Detached from SharedJSContext, failing in-flight evaluations...");
+        m_sharedJsConnected = false;
+        CDP::Client::InstanceRef().FailSession(sessionId, "SharedJSContext session detached");
+    }
+
+    const void onMessage(websocketpp::client<websocketpp::config::asio_client>* c, websocketpp::connection_hdl hdl, websocketpp::config::asio_client::message_type::ptr msg)
+    {
+        // views into the payload stay valid for as long as the message does, so it owns the websocketpp buffer.
+        const CDP::Message message(msg->get_payload(), msg);
+
+        if (!message.IsValid())
+        {
+            LOG_ERROR("received malformed CDP message, ignoring it.");
+            return;
         }
-        webKitHandler.DispatchSocketMessage(json);
+
+        CDP::Client::InstanceRef().Dispatch(message);
+        webKitHandler.DispatchSocketMessage(message);
     }
 
     const void SetupSharedJSContext()
     {
-        Sockets::PostGlobal({ { "id", 0 }, { "method", "Target.getTargets" } });
+        CDP::Client::InstanceRef().Send(CDP::Target::GetTargets {}, [this](const CDP::Message& response)
+        {
+            if (m_sharedJsConnected)
+            {
+                return;
+            }
+
+            const auto targets = response.Json()["result"]["targetInfos"];
+            auto targetIterator = std::find_if(targets.begin(), targets.end(), [](const auto& target) { return target["title"] == "SharedJSContext"; });
+
+            if (targetIterator == targets.end())
+            {
+                this->SetupSharedJSContext();
+                return;
+            }
+
+            const std::string targetId = (*targetIterator)["targetId"];
+            CDP::Client::InstanceRef().Send(CDP::Target::AttachToTarget { targetId, true });
+            m_sharedJsConnected = true;
+        });
     }
 
     const void onSharedJsConnect()
@@ -132,15 +136,14 @@ public:
         std::thread([this]() {
             Logger.Log("Connected to SharedJSContext in {} ms", duration_cast<milliseconds>(system_clock::now() - m_startTime).count());
             CoInitializer::InjectFrontendShims(m_ftpPort, m_ipcPort);
-            Sockets::PostShared({ {"id", 9494 }, {"method", "Console.enable"} });
+            CDP::Client::InstanceRef().SendShared(CDP::Console::Enable {});
         }).detach();
     }
 
     const void onConnect(websocketpp::client<websocketpp::config::asio_client>* client, websocketpp::connection_hdl handle)
     {
         m_startTime = std::chrono::system_clock::now();
-        browserClient = client; 
-        browserHandle = handle;
+        CDP::SendQueue::InstanceRef().Attach(client, handle);
 
         Logger.Log("Connected to Steam @ {}", (void*)client);
 
@@ -151,6 +154,24 @@ public:
     CEFBrowser(uint16_t fptPort, uint16_t ipcPort) : m_ftpPort(fptPort), m_ipcPort(ipcPort), webKitHandler(WebkitHandler::get()) 
     {
         webKitHandler.SetIPCPort(ipcPort);
+
+        m_attachedSubscriberId = CDP::Client::InstanceRef().Subscribe(CDP::Method::Target_attachedToTarget,   std::bind(&CEFBrowser::HandleAttachedToTarget, this, _1));
+        m_detachedSubscriberId = CDP::Client::InstanceRef().Subscribe(CDP::Method::Target_detachedFromTarget, std::bind(&CEFBrowser::HandleDetachedFromTarget, this, _1));
+        m_consoleSubscriberId  = CDP::Client::InstanceRef().Subscribe(CDP::Method::Console_messageAdded,      std::bind(&CEFBrowser::HandleConsoleMessage, this, _1));
+    }
+
+    const void onDisconnect()
+    {
+        CDP::SendQueue::InstanceRef().Detach();
+
+        CDP::Client::InstanceRef().Unsubscribe(CDP::Method::Target_attachedToTarget, m_attachedSubscriberId);
+        CDP::Client::InstanceRef().Unsubscribe(CDP::Method::Target_detachedFromTarget, m_detachedSubscriberId);
+        CDP::Client::InstanceRef().Unsubscribe(CDP::Method::Console_messageAdded, m_consoleSubscriberId);
+        {
+            std::lock_guard<std::mutex> lock(sharedJsContextMutex);
+            sharedJsContextSessionId.clear();
+        }
+        CDP::Client::InstanceRef().Reset();
     }
 };
 
@@ -188,22 +209,16 @@ const std::thread PluginLoader::ConnectCEFBrowser(void* cefBrowserHandler, Socke
 
 const void PluginLoader::InjectWebkitShims() 
 {
-    static std::vector<int> hookIds;
+    static std::vector<unsigned long long> hookIds;
 
-    if (!hookIds.empty())
+    for (const auto hookId : hookIds)
     {
-        const auto moduleList = WebkitHandler::get().m_hookListPtr;
-
-        for (auto it = moduleList->begin(); it != moduleList->end();)
+        if (WebkitHandler::get().RemoveHook(hookId))
         {
-            if (std::find(hookIds.begin(), hookIds.end(), it->id) != hookIds.end())
-            {
-                Logger.Log("Removing hook for module id: {}", it->id);
-                it = moduleList->erase(it);
-            }
-            else ++it;
+            Logger.Log("Removing hook for module id: {}", hookId);
         }
     }
+    hookIds.clear();
 
     const auto allPlugins = this->m_settingsStorePtr->ParseAllPlugins();
     std::vector<SettingsStore::PluginTypeSchema> enabledBackends;
@@ -214,11 +229,21 @@ const void PluginLoader::InjectWebkitShims()
 
         if (this->m_settingsStorePtr->IsEnabledPlugin(plugin.pluginName) && std::filesystem::exists(absolutePath))
         {
-            g_hookedModuleId++;
-            hookIds.push_back(g_hookedModuleId);
-
-            Logger.Log("Injecting hook for '{}' with id {}", plugin.pluginName, g_hookedModuleId);
-            WebkitHandler::get().m_hookListPtr->push_back({ absolutePath.generic_string(), std::regex(".*"), WebkitHandler::TagTypes::JAVASCRIPT, g_hookedModuleId });
+            // only the documents these match are paused for the module, a plugin that doesn't narrow them gets every document.
+            for (const auto& webkitPattern : plugin.webkitPatterns)
+            {
+                try
+                {
+                    const unsigned long long hookId = WebkitHandler::get().AddHook(absolutePath.generic_string(), webkitPattern, WebkitHandler::TagTypes::JAVASCRIPT);
+                    hookIds.push_back(hookId);
+
+                    Logger.Log("Injecting hook for '{}' on '{}' with id {}", plugin.pluginName, webkitPattern, hookId);
+                }
+                catch (const std::regex_error& error)
+                {
+                    LOG_ERROR("plugin '{}' has an invalid webkit pattern '{}' -> {}", plugin.pluginName, webkitPattern, error.what());
+                }
+            }
         }
     }
 }
@@ -238,6 +263,7 @@ const void PluginLoader::StartFrontEnds()
     Logger.Log("Startup took {} ms", duration.count());
 
     browserSocketThread.join();
+    cefBrowserHandler.onDisconnect();
 
     if (g_threadTerminateFlag->flag.load())
     {
@@ -10,6 +10,7 @@
 #include <sys/locals.h>
 #include <socket/await_pipe.h>
 #include <core/py_controller/co_spawn.h>
+#include <core/cdp/send_queue.h>
 
 extern std::shared_ptr<InterpreterMutex> g_threadTerminateFlag;
 
@@ -35,7 +36,8 @@ private:
 };
 
 namespace Sockets {
-	bool PostShared(nlohmann::json data);
-	bool PostGlobal(nlohmann::json data);
+	/* post a message serialized through the CDP bindings, see core/cdp/protocol.h */
+	bool PostPayload(std::string payload, CDP::Lane lane = CDP::Lane::Default, long long messageId = 0);
+	std::string GetSharedSessionId();
 	void Shutdown();
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -7,6 +7,27 @@
 #include <core/co_initialize/co_stub.h>
 // #include <boxer/boxer.h>
 
+/* the plugin whose interpreter the current thread belongs to, set on that plugin's own thread only. */
+static thread_local std::shared_ptr<InterpreterMutex> currentExecutor;
+static thread_local PyThreadState* currentExecutorState = nullptr;
+
+/* runs one of a plugin's tasks on its own thread, the GIL is released again once it returns. */
+static void RunTask(const std::shared_ptr<InterpreterMutex>& executor, PyThreadState* threadState, const std::function<void()>& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(executor->mtx);
+        executor->running++;
+    }
+
+    PyEval_RestoreThread(threadState);
+    task();
+    PyEval_SaveThread();
+
+    std::lock_guard<std::mutex> lock(executor->mtx);
+    executor->running--;
+    executor->completed++;
+}
+
 std::string ThreadIdToString(const std::thread::id& id) {
     std::stringstream ss;
     ss << std::hash<std::thread::id>{}(id);
@@ -193,6 +214,9 @@ bool PythonManager::CreatePythonInstance(SettingsStore::PluginTypeSchema& plugin
 
         PyThreadState_Swap(interpreterState);
         
+        currentExecutor = interpMutexStatePtr;
+        currentExecutorState = interpreterState;
+
         this->m_pythonInstances.push_back({ pluginName, interpreterState, interpMutexStatePtr });
         Logger.Log("Redirecting stdout/stderr for plugin '{}'", pluginName);
         RedirectOutput();
@@ -203,11 +227,34 @@ bool PythonManager::CreatePythonInstance(SettingsStore::PluginTypeSchema& plugin
         PyThreadState_Swap(threadStateMain);
         PyThreadState_DeleteCurrent();
 
-        // Sit on the mutex until daddy says it's time to go
-        std::unique_lock<std::mutex> lock(interpMutexStatePtr->mtx);
-        interpMutexStatePtr->cv.wait(lock, [interpMutexStatePtr] { 
-            return interpMutexStatePtr->flag.load();
-        });
+        // from here on this thread is the interpreter's executor, it runs what's submitted to it until daddy says it's time to go.
+        interpMutexStatePtr->executing.store(true);
+
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(interpMutexStatePtr->mtx);
+                interpMutexStatePtr->cv.wait(lock, [interpMutexStatePtr] { 
+                    return interpMutexStatePtr->flag.load() || !interpMutexStatePtr->tasks.empty();
+                });
+
+                // only leave once everything accepted before the shutdown has run
+                if (interpMutexStatePtr->tasks.empty())
+                {
+                    break;
+                }
+
+                task = std::move(interpMutexStatePtr->tasks.front());
+                interpMutexStatePtr->tasks.pop_front();
+            }
+
+            RunTask(interpMutexStatePtr, interpreterState, task);
+        }
+
+        interpMutexStatePtr->executing.store(false);
+        currentExecutor.reset();
+        currentExecutorState = nullptr;
 
         Logger.Log("Orphaned '{}', jumping off the mutex lock...", pluginName);
         
@@ -221,6 +268,7 @@ bool PythonManager::CreatePythonInstance(SettingsStore::PluginTypeSchema& plugin
         }
 
         Logger.Log("Shutting down plugin '{}'", pluginName);
+        InterpreterLock::Purge(PyThreadState_GetInterpreter(interpreterState));
         Py_EndInterpreter(interpreterState);
         Logger.Log("Ended sub-interpreter...", pluginName);
         pythonGilLock->ReleaseAndUnLockGIL();
@@ -238,12 +286,108 @@ PythonThreadState PythonManager::GetPythonThreadStateFromName(std::string target
     {
         if (targetPluginName == pluginName) 
         {
-            return { pluginName, thread_ptr };
+            return { pluginName, thread_ptr, interpMutex };
         }
     }
     return {};
 }
 
+bool PythonManager::Post(const std::string& pluginName, std::function<void()> task)
+{
+    std::shared_ptr<InterpreterMutex> executor = this->GetPythonThreadStateFromName(pluginName).mutex;
+
+    // before _load returns nothing would run it, plugins are free to never return from it.
+    if (!executor || !executor->executing.load())
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(executor->mtx);
+
+        if (executor->flag.load())
+        {
+            return false;
+        }
+        executor->tasks.emplace_back(std::move(task));
+    }
+
+    executor->cv.notify_all();
+    return true;
+}
+
+bool PythonManager::IsExecuting(const std::string& pluginName)
+{
+    std::shared_ptr<InterpreterMutex> executor = this->GetPythonThreadStateFromName(pluginName).mutex;
+    return executor && executor->executing.load() && !executor->flag.load();
+}
+
+std::vector<PythonManager::ExecutorGauge> PythonManager::ExecutorGauges()
+{
+    std::vector<ExecutorGauge> gauges;
+
+    for (const auto& [pluginName, thread_ptr, interpMutex] : this->m_pythonInstances)
+    {
+        if (!interpMutex)
+        {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(interpMutex->mtx);
+        gauges.push_back({ pluginName, interpMutex->tasks.size(), interpMutex->running, interpMutex->completed });
+    }
+    return gauges;
+}
+
+bool PythonManager::IsCurrentExecutor(const std::shared_ptr<InterpreterMutex>& executor)
+{
+    return currentExecutor == executor;
+}
+
+PythonManager::Wakeup PythonManager::GetWakeup()
+{
+    if (!currentExecutor)
+    {
+        return nullptr;
+    }
+
+    return [executor = std::weak_ptr<InterpreterMutex>(currentExecutor)]
+    {
+        if (auto interpMutex = executor.lock())
+        {
+            // taking the lock orders this after the waiter last checked its condition, so the notify can't be missed.
+            { std::lock_guard<std::mutex> lock(interpMutex->mtx); }
+            interpMutex->cv.notify_all();
+        }
+    };
+}
+
+bool PythonManager::RunTasksUntil(const std::function<bool()>& isDone, std::chrono::steady_clock::time_point deadline)
+{
+    if (!currentExecutor)
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(currentExecutor->mtx);
+
+            if (!currentExecutor->cv.wait_until(lock, deadline, [&isDone] { return isDone() || !currentExecutor->tasks.empty(); }) || isDone())
+            {
+                return true;
+            }
+
+            task = std::move(currentExecutor->tasks.front());
+            currentExecutor->tasks.pop_front();
+        }
+
+        RunTask(currentExecutor, currentExecutorState, task);
+    }
+}
+
 std::string PythonManager::GetPluginNameFromThreadState(PyThreadState* thread) 
 {
     for (const auto& [pluginName, thread_ptr, interpMutex] : this->m_pythonInstances)
@@ -254,4 +398,4 @@ std::string PythonManager::GetPluginNameFromThreadState(PyThreadState* thread)
         }
     }
     return {};
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -6,6 +6,10 @@
 #include <string>
 #include <sys/locals.h>
 #include <condition_variable>
+#include <deque>
+#include <future>
+#include <stdexcept>
+#include <type_traits>
 #include <atomic>
 #include <sys/log.h>
 #include <filesystem>
@@ -14,6 +18,14 @@ struct InterpreterMutex {
     std::mutex mtx;
     std::condition_variable cv;
     std::atomic<bool> flag {false};
+
+    /* work for the plugin's own thread, run in order with the GIL held once _load has returned. */
+    std::deque<std::function<void()>> tasks;
+    std::atomic<bool> executing {false};
+
+    /* guarded by mtx, running is above one while a task waits in RunTasksUntil. */
+    std::size_t running = 0;
+    unsigned long long completed = 0;
 };
 
 struct PythonThreadState {
@@ -54,8 +66,94 @@ public:
 	PythonThreadState GetPythonThreadStateFromName(std::string pluginName);
 	std::string GetPluginNameFromThreadState(PyThreadState* thread);
 
+	/**
+	 * @brief run `fn` on the plugin's own thread, inside its interpreter with the GIL held. Tasks run one at a time
+	 * in the order they were submitted. Called from that thread (i.e from within a task) `fn` runs right away.
+	 *
+	 * @return the result of `fn`, or a std::runtime_error if the plugin isn't running or is shutting down.
+	 */
+	template <typename Fn>
+	auto Submit(const std::string& pluginName, Fn fn) -> std::future<std::invoke_result_t<Fn>>;
+
+	/**
+	 * @brief queue `task` on the plugin's own thread without waiting for it, it runs inside the interpreter with the GIL held.
+	 * @return false if the plugin's thread isn't taking tasks (still in _load, or shutting down), `task` is dropped then.
+	 */
+	bool Post(const std::string& pluginName, std::function<void()> task);
+
+	/// @return whether the plugin's thread has finished loading and is taking tasks.
+	bool IsExecuting(const std::string& pluginName);
+
+	struct ExecutorGauge
+	{
+		std::string pluginName;
+		std::size_t queued;
+		std::size_t running;
+		unsigned long long completed;
+	};
+
+	/// @return the depth of every running plugin's task queue, i.e the backend calls made after _load returned.
+	std::vector<ExecutorGauge> ExecutorGauges();
+
+	/* wakes a plugin's thread out of RunTasksUntil to check its condition again, callable from any thread at any time. */
+	using Wakeup = std::function<void()>;
+
+	/// @return the wakeup for the calling thread, or nullptr if it isn't a plugin's thread.
+	static Wakeup GetWakeup();
+
+	/**
+	 * @brief on a plugin's thread (with the GIL released), run its tasks as they come in until `isDone` returns true or
+	 * `deadline` passes. keeps a plugin's queue moving while it blocks on something that may call back into it, whatever
+	 * makes `isDone` true has to call the thread's wakeup (see GetWakeup) once it has.
+	 *
+	 * @return false if the calling thread isn't a plugin's thread.
+	 */
+	static bool RunTasksUntil(const std::function<bool()>& isDone, std::chrono::steady_clock::time_point deadline);
+
 	static PythonManager& GetInstance() {
 		static PythonManager InstanceRef;
 		return InstanceRef;
 	}
-};
\ No newline at end of file
+
+private:
+	static bool IsCurrentExecutor(const std::shared_ptr<InterpreterMutex>& executor);
+};
+
+template <typename Fn>
+auto PythonManager::Submit(const std::string& pluginName, Fn fn) -> std::future<std::invoke_result_t<Fn>>
+{
+	using Result = std::invoke_result_t<Fn>;
+
+	auto task = std::make_shared<std::packaged_task<Result()>>(std::move(fn));
+	std::future<Result> result = task->get_future();
+	std::shared_ptr<InterpreterMutex> executor = this->GetPythonThreadStateFromName(pluginName).mutex;
+
+	if (executor && IsCurrentExecutor(executor))
+	{
+		(*task)(); // already inside the interpreter, queueing it would deadlock
+		return result;
+	}
+
+	bool accepted = false;
+
+	if (executor)
+	{
+		std::lock_guard<std::mutex> lock(executor->mtx);
+
+		if (!executor->flag.load())
+		{
+			executor->tasks.emplace_back([task] { (*task)(); });
+			accepted = true;
+		}
+	}
+
+	if (!accepted)
+	{
+		std::promise<Result> refused;
+		refused.set_exception(std::make_exception_ptr(std::runtime_error(fmt::format("plugin [{}] isn't running", pluginName))));
+		return refused.get_future();
+	}
+
+	executor->cv.notify_all();
+	return result;
+}
@@ -0,0 +1,369 @@
+#include "encoding.h"
+#include <array>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #include <immintrin.h>
+    #define BASE64_SIMD
+    #define BASE64_TARGET_SSSE3
+    #define BASE64_TARGET_AVX2
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #include <immintrin.h>
+    #define BASE64_SIMD
+    #if defined(__i386__)
+        // windows only guarantees 4 byte stack alignment on x86, realign before touching vector registers.
+        #define BASE64_TARGET_SSSE3 __attribute__((target("ssse3"), force_align_arg_pointer))
+        #define BASE64_TARGET_AVX2  __attribute__((target("avx2"), force_align_arg_pointer))
+    #else
+        #define BASE64_TARGET_SSSE3 __attribute__((target("ssse3")))
+        #define BASE64_TARGET_AVX2  __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace
+{
+    constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    constexpr std::array<std::int8_t, 256> MakeDecodeTable()
+    {
+        std::array<std::int8_t, 256> table {};
+
+        for (auto& value : table) value = -1;
+        for (int i = 0; i < 64; i++) table[static_cast<unsigned char>(alphabet[i])] = static_cast<std::int8_t>(i);
+
+        return table;
+    }
+
+    constexpr std::array<std::int8_t, 256> decodeTable = MakeDecodeTable();
+
+    std::size_t EncodeScalar(const unsigned char* in, std::size_t size, char* out)
+    {
+        char* const start = out;
+
+        for (; size >= 3; in += 3, size -= 3)
+        {
+            const std::uint32_t group = (in[0] << 16) | (in[1] << 8) | in[2];
+
+            *out++ = alphabet[(group >> 18) & 0x3F];
+            *out++ = alphabet[(group >> 12) & 0x3F];
+            *out++ = alphabet[(group >> 6) & 0x3F];
+            *out++ = alphabet[group & 0x3F];
+        }
+
+        if (size > 0)
+        {
+            const std::uint32_t group = (in[0] << 16) | (size > 1 ? in[1] << 8 : 0);
+
+            *out++ = alphabet[(group >> 18) & 0x3F];
+            *out++ = alphabet[(group >> 12) & 0x3F];
+            *out++ = size > 1 ? alphabet[(group >> 6) & 0x3F] : '=';
+            *out++ = '=';
+        }
+        return out - start;
+    }
+
+    std::size_t DecodeScalar(const unsigned char* in, std::size_t size, unsigned char* out)
+    {
+        unsigned char* const start = out;
+
+        // whole groups first, then whatever is left one character at a time like the original decoder.
+        for (; size >= 4; in += 4, size -= 4)
+        {
+            const int a = decodeTable[in[0]], b = decodeTable[in[1]], c = decodeTable[in[2]], d = decodeTable[in[3]];
+
+            if ((a | b | c | d) < 0)
+            {
+                break;
+            }
+
+            const std::uint32_t group = (a << 18) | (b << 12) | (c << 6) | d;
+
+            *out++ = static_cast<unsigned char>(group >> 16);
+            *out++ = static_cast<unsigned char>(group >> 8);
+            *out++ = static_cast<unsigned char>(group);
+        }
+
+        int value = 0, bits = -8;
+
+        for (; size > 0; in++, size--)
+        {
+            const int decoded = decodeTable[*in];
+
+            if (decoded < 0)
+            {
+                break;
+            }
+
+            value = (value << 6) + decoded;
+            bits += 6;
+
+            if (bits >= 0)
+            {
+                *out++ = static_cast<unsigned char>((value >> bits) & 0xFF);
+                bits -= 8;
+            }
+        }
+        return out - start;
+    }
+
+#ifdef BASE64_SIMD
+    /*
+     * The vector paths follow Wojciech Muła's & Daniel Lemire's "Faster Base64 Encoding and Decoding using AVX2
+     * Instructions": bytes are spread into 6 bit indices with a shuffle and two multiplies, and mapped to/from
+     * ascii through a 16 entry offset table so there are no per byte lookups.
+     */
+    BASE64_TARGET_SSSE3 inline __m128i EncodeLookup(__m128i indices)
+    {
+        const __m128i shiftTable = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                 '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+        __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+
+        return _mm_add_epi8(_mm_shuffle_epi8(shiftTable, result), indices);
+    }
+
+    BASE64_TARGET_SSSE3 inline __m128i SplitIndices(__m128i in)
+    {
+        in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+        const __m128i high = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+        const __m128i low = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+
+        return _mm_or_si128(high, low);
+    }
+
+    BASE64_TARGET_SSSE3 std::size_t EncodeSSSE3(const unsigned char* in, std::size_t size, char* out)
+    {
+        char* const start = out;
+
+        // 16 bytes are loaded for every 12 that are encoded.
+        for (; size >= 16; in += 12, size -= 12, out += 16)
+        {
+            const __m128i indices = SplitIndices(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), EncodeLookup(indices));
+        }
+        return (out - start) + EncodeScalar(in, size, out);
+    }
+
+    BASE64_TARGET_SSSE3 std::size_t DecodeSSSE3(const unsigned char* in, std::size_t size, unsigned char* out)
+    {
+        unsigned char* const start = out;
+
+        const __m128i lowTable = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m128i highTable = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m128i rollTable = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i mask2F = _mm_set1_epi8(0x2F);
+
+        // 16 bytes are stored for every 12 decoded, keep enough input around that the extra 4 land in the buffer.
+        for (; size >= 24; in += 16, size -= 16, out += 12)
+        {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+
+            const __m128i highNibbles = _mm_and_si128(_mm_srli_epi32(chars, 4), mask2F);
+            const __m128i lowNibbles = _mm_and_si128(chars, mask2F);
+            const __m128i invalid = _mm_and_si128(_mm_shuffle_epi8(lowTable, lowNibbles), _mm_shuffle_epi8(highTable, highNibbles));
+
+            // padding or garbage somewhere in this block, let the scalar code find where to stop.
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) != 0xFFFF)
+            {
+                break;
+            }
+
+            const __m128i roll = _mm_shuffle_epi8(rollTable, _mm_add_epi8(_mm_cmpeq_epi8(chars, mask2F), highNibbles));
+            chars = _mm_add_epi8(chars, roll);
+
+            const __m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(chars, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+            const __m128i packed = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+        }
+        return (out - start) + DecodeScalar(in, size, out);
+    }
+
+    BASE64_TARGET_AVX2 std::size_t EncodeAVX2(const unsigned char* in, std::size_t size, char* out)
+    {
+        char* const start = out;
+
+        const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+        const __m256i shiftTable = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                    '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                                    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                    '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+        // each lane encodes 12 bytes, the second lane is loaded from 12 bytes in, so 28 have to be readable.
+        for (; size >= 28; in += 24, size -= 24, out += 32)
+        {
+            __m256i bytes = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in))),
+                                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 12)), 1);
+            bytes = _mm256_shuffle_epi8(bytes, shuffle);
+
+            const __m256i high = _mm256_mulhi_epu16(_mm256_and_si256(bytes, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+            const __m256i low = _mm256_mullo_epi16(_mm256_and_si256(bytes, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+            const __m256i indices = _mm256_or_si256(high, low);
+
+            __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+            const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+            result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+            result = _mm256_add_epi8(_mm256_shuffle_epi8(shiftTable, result), indices);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), result);
+        }
+        return (out - start) + EncodeSSSE3(in, size, out);
+    }
+
+    BASE64_TARGET_AVX2 std::size_t DecodeAVX2(const unsigned char* in, std::size_t size, unsigned char* out)
+    {
+        unsigned char* const start = out;
+
+        const __m256i lowTable = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                                                  0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m256i highTable = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                                   0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m256i rollTable = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                   0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                              2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        const __m256i mask2F = _mm256_set1_epi8(0x2F);
+
+        // 32 bytes are stored for every 24 decoded.
+        for (; size >= 48; in += 32, size -= 32, out += 24)
+        {
+            __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+
+            const __m256i highNibbles = _mm256_and_si256(_mm256_srli_epi32(chars, 4), mask2F);
+            const __m256i lowNibbles = _mm256_and_si256(chars, mask2F);
+
+            if (!_mm256_testz_si256(_mm256_shuffle_epi8(lowTable, lowNibbles), _mm256_shuffle_epi8(highTable, highNibbles)))
+            {
+                break;
+            }
+
+            const __m256i roll = _mm256_shuffle_epi8(rollTable, _mm256_add_epi8(_mm256_cmpeq_epi8(chars, mask2F), highNibbles));
+            chars = _mm256_add_epi8(chars, roll);
+
+            __m256i merged = _mm256_madd_epi16(_mm256_maddubs_epi16(chars, _mm256_set1_epi32(0x01400140)), _mm256_set1_epi32(0x00011000));
+            merged = _mm256_shuffle_epi8(merged, pack);
+            merged = _mm256_permutevar8x32_epi32(merged, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), merged);
+        }
+        return (out - start) + DecodeSSSE3(in, size, out);
+    }
+
+    bool CpuSupports(bool avx2)
+    {
+    #if defined(_MSC_VER)
+        int registers[4];
+        __cpuid(registers, 1);
+
+        if (!avx2)
+        {
+            return (registers[2] & (1 << 9)) != 0;
+        }
+
+        // the os also has to save the ymm registers on a context switch.
+        const bool osSavesYmm = (registers[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(registers, 7, 0);
+        return osSavesYmm && (registers[1] & (1 << 5)) != 0;
+    #else
+        __builtin_cpu_init();
+        return avx2 ? __builtin_cpu_supports("avx2") : __builtin_cpu_supports("ssse3");
+    #endif
+    }
+#endif
+
+    struct Codec
+    {
+        std::size_t (*encode)(const unsigned char*, std::size_t, char*);
+        std::size_t (*decode)(const unsigned char*, std::size_t, unsigned char*);
+    };
+
+    const Codec& GetCodec()
+    {
+        static const Codec codec = []() -> Codec
+        {
+        #ifdef BASE64_SIMD
+            if (CpuSupports(true))  return { EncodeAVX2, DecodeAVX2 };
+            if (CpuSupports(false)) return { EncodeSSSE3, DecodeSSSE3 };
+        #endif
+            return { EncodeScalar, DecodeScalar };
+        }();
+
+        return codec;
+    }
+}
+
+std::size_t Base64EncodeInto(const unsigned char* in, std::size_t size, char* out)
+{
+    return GetCodec().encode(in, size, out);
+}
+
+std::size_t Base64DecodeInto(std::string_view in, unsigned char* out)
+{
+    return GetCodec().decode(reinterpret_cast<const unsigned char*>(in.data()), in.size(), out);
+}
+
+std::string Base64Encode(std::string_view in)
+{
+    std::string out(Base64EncodedSize(in.size()), '\0');
+    Base64EncodeInto(reinterpret_cast<const unsigned char*>(in.data()), in.size(), out.data());
+    return out;
+}
+
+std::string Base64Decode(std::string_view in)
+{
+    std::string out(Base64DecodedMaxSize(in.size()), '\0');
+    out.resize(Base64DecodeInto(in, reinterpret_cast<unsigned char*>(out.data())));
+    return out;
+}
+
+void Base64StreamEncoder::Append(std::string_view in)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(in.data());
+    std::size_t size = in.size();
+
+    // top up the bytes held back from the last call first.
+    while (m_carrySize > 0 && m_carrySize < 3 && size > 0)
+    {
+        m_carry[m_carrySize++] = *bytes++;
+        size--;
+    }
+
+    if (m_carrySize == 3)
+    {
+        const std::size_t offset = m_out.size();
+        m_out.resize(offset + 4);
+        Base64EncodeInto(m_carry, 3, m_out.data() + offset);
+        m_carrySize = 0;
+    }
+
+    const std::size_t whole = size / 3 * 3;
+
+    if (whole > 0)
+    {
+        const std::size_t offset = m_out.size();
+        m_out.resize(offset + Base64EncodedSize(whole));
+        Base64EncodeInto(bytes, whole, m_out.data() + offset);
+    }
+
+    for (std::size_t i = whole; i < size; i++)
+    {
+        m_carry[m_carrySize++] = bytes[i];
+    }
+}
+
+void Base64StreamEncoder::Finish()
+{
+    if (m_carrySize == 0)
+    {
+        return;
+    }
+
+    const std::size_t offset = m_out.size();
+    m_out.resize(offset + 4);
+    Base64EncodeInto(m_carry, m_carrySize, m_out.data() + offset);
+    m_carrySize = 0;
+}
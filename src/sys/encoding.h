@@ -1,56 +1,59 @@
 #pragma once
 #include <string>
-#include <vector>
+#include <string_view>
+#include <cstddef>
 
-// https://stackoverflow.com/questions/180947/base64-decode-snippet-in-c
+/**
+ * Base64 (RFC 4648, padded) used for CDP bodies and IPC string returns.
+ *
+ * The bulk of the input is encoded/decoded 24 or 12 bytes at a time with AVX2 or SSSE3 when the cpu has it,
+ * picked once at runtime, and the tail is handled by the scalar code, so the output is the same on every path.
+ */
 
-static const std::string base64_chars =
-             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-             "abcdefghijklmnopqrstuvwxyz"
-             "0123456789+/";
-
-static inline bool is_base64(unsigned char c) 
+/// @return the exact size of the encoded form of `size` bytes, padding included.
+constexpr std::size_t Base64EncodedSize(std::size_t size)
 {
-    return (isalnum(c) || (c == '+') || (c == '/'));
+    return (size + 2) / 3 * 4;
 }
 
-static std::string Base64Decode(const std::string &in) 
+/// @return an upper bound for the decoded size of `size` characters.
+constexpr std::size_t Base64DecodedMaxSize(std::size_t size)
 {
-    std::string out;
-    std::vector<int> T(256,-1);
-    for (int i=0; i<64; i++) T["ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[i]] = i;
-
-    int val=0, valb=-8;
-    for (unsigned char c : in) 
-    {
-        if (T[c] == -1) break;
-        val = (val << 6) + T[c];
-        valb += 6;
-        if (valb >= 0) 
-        {
-            out.push_back(char((val>>valb)&0xFF));
-            valb -= 8;
-        }
-    }
-    return out;
+    return size / 4 * 3 + 2;
 }
 
-static std::string Base64Encode(const std::string &in) 
+/**
+ * @brief encode `size` bytes into `out`, which must have room for Base64EncodedSize(size) characters.
+ * @return the number of characters written.
+ */
+std::size_t Base64EncodeInto(const unsigned char* in, std::size_t size, char* out);
+
+/**
+ * @brief decode `in` into `out`, which must have room for Base64DecodedMaxSize(in.size()) bytes.
+ * decoding stops at the first character that isn't part of the alphabet (i.e the padding).
+ * @return the number of bytes written.
+ */
+std::size_t Base64DecodeInto(std::string_view in, unsigned char* out);
+
+std::string Base64Encode(std::string_view in);
+std::string Base64Decode(std::string_view in);
+
+/**
+ * Encodes bytes that arrive in pieces into `out`, holding back the 1-2 bytes that don't fill a group of three
+ * until the next Append so the result is identical to encoding everything at once.
+ */
+class Base64StreamEncoder
 {
-    std::string out;
-
-    int val = 0, valb = -6;
-    for (unsigned char c : in) 
-    {
-        val = (val << 8) + c;
-        valb += 8;
-        while (valb >= 0) 
-        {
-            out.push_back("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[(val>>valb)&0x3F]);
-            valb -= 6;
-        }
-    }
-    if (valb>-6) out.push_back("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[((val<<8)>>(valb+8))&0x3F]);
-    while (out.size()%4) out.push_back('=');
-    return out;
-}
\ No newline at end of file
+public:
+    explicit Base64StreamEncoder(std::string& out) : m_out(out) {}
+
+    void Append(std::string_view in);
+
+    /// @brief flush the held back bytes and pad the output.
+    void Finish();
+
+private:
+    std::string& m_out;
+    unsigned char m_carry[3];
+    std::size_t m_carrySize = 0;
+};
@@ -0,0 +1,54 @@
+#include "file_cache.h"
+#include <sys/log.h>
+
+namespace
+{
+    SystemIO::FileStore& GetFileStore()
+    {
+        static SystemIO::FileStore fileStore;
+        return fileStore;
+    }
+}
+
+SystemIO::CachedFile::CachedFile(std::filesystem::path filePath, Renderer render)
+    : m_filePath(std::move(filePath)), m_render(std::move(render)) { }
+
+std::shared_ptr<const std::string> SystemIO::CachedFile::Get()
+{
+    const auto file = GetFileStore().Get(m_filePath);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!file)
+    {
+        if (m_contents)
+        {
+            LOG_ERROR("failed to read file -> {}", m_filePath.string());
+        }
+
+        m_source.reset();
+        m_contents.reset();
+        return nullptr;
+    }
+
+    if (m_contents && file == m_source)
+    {
+        return m_contents;
+    }
+
+    // the store may have dropped and re-read the file without it changing, that doesn't need a new render.
+    if (m_contents && m_source && file->etag == m_source->etag)
+    {
+        m_source = file;
+        return m_contents;
+    }
+
+    if (m_contents)
+    {
+        Logger.Log("{} changed on disk, reloading it...", m_filePath.filename().string());
+    }
+
+    m_source = file;
+    m_contents = std::make_shared<const std::string>(m_render ? m_render(file->contents) : file->contents);
+    return m_contents;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <filesystem>
+#include <sys/file_store.h>
+
+namespace SystemIO
+{
+    /**
+     * A file that's read on a hot path, rendered into what callers actually use (i.e the shim wrapped in its
+     * <script> tag). The file itself comes from a FileStore, so it's only re-read when the watcher (or, for
+     * directories that can't be watched, its size and mtime) says it changed, and rendered once per change.
+     *
+     * Get hands out the same pointer for as long as the file's contents don't change.
+     */
+    class CachedFile
+    {
+    public:
+        using Renderer = std::function<std::string(std::string contents)>;
+
+        explicit CachedFile(std::filesystem::path filePath, Renderer render = nullptr);
+
+        /// @return the rendered contents, or nullptr if the file can't be read.
+        std::shared_ptr<const std::string> Get();
+
+    private:
+        std::mutex m_mutex;
+        std::filesystem::path m_filePath;
+        Renderer m_render;
+
+        std::shared_ptr<const FileStore::File> m_source;
+        std::shared_ptr<const std::string> m_contents;
+    };
+}
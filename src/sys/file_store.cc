@@ -0,0 +1,118 @@
+#include "file_store.h"
+#include "hash.h"
+#include <fstream>
+#include <algorithm>
+#include <fmt/core.h>
+
+namespace
+{
+    std::string MakeKey(const std::filesystem::path& filePath)
+    {
+        return filePath.lexically_normal().generic_string();
+    }
+}
+
+SystemIO::FileStore::FileStore(std::size_t capacity) : m_files(capacity), m_watcher([this](const std::filesystem::path& changedPath) { this->Invalidate(changedPath); }) { }
+
+std::shared_ptr<const SystemIO::FileStore::File> SystemIO::FileStore::Get(const std::filesystem::path& filePath)
+{
+    const std::string key = MakeKey(filePath);
+    const std::string directory = MakeKey(filePath.parent_path());
+    unsigned long long generation;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Entry* cached = m_files.Get(key);
+
+        if (cached && cached->watched)
+        {
+            return cached->file;
+        }
+
+        if (cached && cached->file)
+        {
+            std::error_code errorCode;
+            const auto lastWriteTime = std::filesystem::last_write_time(filePath, errorCode);
+            const auto fileSize = errorCode ? 0 : std::filesystem::file_size(filePath, errorCode);
+
+            if (!errorCode && lastWriteTime == cached->file->lastWriteTime && fileSize == cached->file->fileSize)
+            {
+                return cached->file;
+            }
+        }
+
+        if (!m_watchedDirectories.count(directory))
+        {
+            m_watchedDirectories[directory] = m_watcher.Watch(filePath.parent_path());
+        }
+        generation = m_generation;
+    }
+
+    // read without holding the lock, a change that lands meanwhile bumps the generation.
+    std::shared_ptr<const File> file = this->Load(filePath);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const bool watched = m_watchedDirectories[directory] && generation == m_generation;
+
+    // files that don't exist are remembered too (i.e precompressed siblings), the watcher reports when they show up.
+    if (!file && !watched)
+    {
+        m_files.Remove(key);
+        return nullptr;
+    }
+
+    m_files.Put(key, Entry { file, watched }, file ? std::max<std::size_t>(file->contents.size(), 1) : 1);
+    return file;
+}
+
+std::shared_ptr<const SystemIO::FileStore::File> SystemIO::FileStore::Load(const std::filesystem::path& filePath)
+{
+    std::error_code errorCode;
+    const auto lastWriteTime = std::filesystem::last_write_time(filePath, errorCode);
+
+    if (errorCode || !std::filesystem::is_regular_file(filePath, errorCode))
+    {
+        return nullptr;
+    }
+
+    std::ifstream fileStream(filePath, std::ios::binary);
+
+    if (!fileStream.is_open())
+    {
+        return nullptr;
+    }
+
+    auto file = std::make_shared<File>();
+    file->contents.assign(std::istreambuf_iterator<char>(fileStream), std::istreambuf_iterator<char>());
+    file->lastWriteTime = lastWriteTime;
+    file->fileSize = file->contents.size();
+    file->etag = fmt::format("\"{:016x}-{:x}\"", HashContents(file->contents), file->contents.size());
+    return file;
+}
+
+void SystemIO::FileStore::Invalidate(const std::filesystem::path& changedPath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_generation++;
+
+    if (changedPath.empty())
+    {
+        m_files.Clear();
+        return;
+    }
+
+    const std::string key = MakeKey(changedPath);
+
+    if (m_files.Remove(key))
+    {
+        return;
+    }
+
+    // events for the directory itself mean anything in it may have changed.
+    if (m_watchedDirectories.count(key))
+    {
+        m_files.RemoveIf([&key](const std::string& filePath) { return MakeKey(std::filesystem::path(filePath).parent_path()) == key; });
+
+        // a directory that was removed or renamed isn't watched anymore.
+        m_watchedDirectories.erase(key);
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <mutex>
+#include <filesystem>
+#include <unordered_map>
+#include <sys/file_watcher.h>
+#include <sys/lru_cache.h>
+
+namespace SystemIO
+{
+    /**
+     * Files served over and over (plugin modules, frontend assets), kept in memory with a strong ETag.
+     *
+     * Entries are dropped when the file watcher sees their file change, so a hit is a single lookup. If a
+     * directory can't be watched, entries from it are revalidated against the file's size and mtime instead.
+     * Every read hands out a new File, so anything derived from one can be cached against the File's identity.
+     *
+     * The store holds at most `capacity` bytes of contents, the least recently used files are dropped past that.
+     */
+    class FileStore
+    {
+    public:
+        struct File
+        {
+            std::string contents;
+            std::string etag; // quoted, ready to be sent as is
+
+            std::filesystem::file_time_type lastWriteTime;
+            std::uintmax_t fileSize;
+        };
+
+        static constexpr std::size_t DefaultCapacity = 64 * 1024 * 1024;
+
+        explicit FileStore(std::size_t capacity = DefaultCapacity);
+
+        /// @return the file, or nullptr if it can't be read.
+        std::shared_ptr<const File> Get(const std::filesystem::path& filePath);
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<const File> file; // nullptr if the file doesn't exist
+            bool watched; // no change since it was read was missed, so it doesn't have to be revalidated
+        };
+
+        std::shared_ptr<const File> Load(const std::filesystem::path& filePath);
+        void Invalidate(const std::filesystem::path& changedPath);
+
+        std::mutex m_mutex;
+        LruCache<std::string, Entry> m_files;
+        std::unordered_map<std::string, bool> m_watchedDirectories;
+        unsigned long long m_generation = 0;
+
+        FileWatcher m_watcher;
+    };
+}
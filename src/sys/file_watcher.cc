@@ -0,0 +1,259 @@
+#include "file_watcher.h"
+#include <sys/log.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <windows.h>
+#elif __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+struct SystemIO::FileWatcher::Backend
+{
+    Callback onChange;
+    std::atomic<bool> stopping { false };
+
+    std::mutex mutex;
+    std::unordered_map<std::wstring, std::thread> directories;
+    std::vector<std::thread> exited; // workers whose directory went away, joined with the rest on destruction
+
+    void WatchDirectory(std::filesystem::path directory, HANDLE directoryHandle)
+    {
+        OVERLAPPED overlapped {};
+        overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+
+        alignas(DWORD) char buffer[16 * 1024];
+        const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+
+        while (!stopping)
+        {
+            ResetEvent(overlapped.hEvent);
+
+            if (!ReadDirectoryChangesW(directoryHandle, buffer, sizeof(buffer), FALSE, filter, NULL, &overlapped, NULL))
+            {
+                LOG_ERROR("failed to watch {} for changes, error {}", directory.string(), GetLastError());
+                CloseHandle(overlapped.hEvent);
+                CloseHandle(directoryHandle);
+
+                // i.e the directory was deleted or replaced. forget it before reporting the change, so the next
+                // Watch opens it again (or reports it can't be watched) rather than trusting a dead worker.
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    auto watched = directories.find(directory.wstring());
+
+                    if (watched != directories.end())
+                    {
+                        exited.push_back(std::move(watched->second));
+                        directories.erase(watched);
+                    }
+                }
+
+                onChange(directory);
+                return;
+            }
+
+            // wake up every now and then to see if the watcher is going away.
+            while (WaitForSingleObject(overlapped.hEvent, 250) == WAIT_TIMEOUT && !stopping) { }
+
+            DWORD bytesReturned = 0;
+
+            if (stopping)
+            {
+                CancelIo(directoryHandle);
+                GetOverlappedResult(directoryHandle, &overlapped, &bytesReturned, TRUE);
+                break;
+            }
+
+            // zero bytes means the buffer overflowed and the changes were dropped.
+            if (!GetOverlappedResult(directoryHandle, &overlapped, &bytesReturned, FALSE) || bytesReturned == 0)
+            {
+                onChange(directory);
+                continue;
+            }
+
+            for (std::size_t offset = 0;;)
+            {
+                const auto* notification = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+                onChange(directory / std::wstring(notification->FileName, notification->FileNameLength / sizeof(WCHAR)));
+
+                if (notification->NextEntryOffset == 0)
+                {
+                    break;
+                }
+                offset += notification->NextEntryOffset;
+            }
+        }
+
+        CloseHandle(overlapped.hEvent);
+        CloseHandle(directoryHandle);
+    }
+
+    bool Watch(const std::filesystem::path& directory)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (directories.count(directory.wstring()))
+        {
+            return true;
+        }
+
+        HANDLE directoryHandle = CreateFileW(directory.wstring().c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 
+            NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+
+        if (directoryHandle == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        directories.emplace(directory.wstring(), std::thread(&Backend::WatchDirectory, this, directory, directoryHandle));
+        return true;
+    }
+
+    ~Backend()
+    {
+        stopping = true;
+
+        for (auto& [path, thread] : directories)
+        {
+            thread.join();
+        }
+        for (auto& thread : exited)
+        {
+            thread.join();
+        }
+    }
+};
+#elif __linux__
+struct SystemIO::FileWatcher::Backend
+{
+    Callback onChange;
+    std::atomic<bool> stopping { false };
+    int inotifyFd = -1;
+    std::thread thread;
+
+    std::mutex mutex;
+    std::unordered_map<int, std::filesystem::path> directories;
+
+    void Run()
+    {
+        alignas(inotify_event) char buffer[16 * 1024];
+
+        while (!stopping)
+        {
+            // wake up every now and then to see if the watcher is going away.
+            pollfd pollDescriptor { inotifyFd, POLLIN, 0 };
+
+            if (poll(&pollDescriptor, 1, 250) <= 0)
+            {
+                continue;
+            }
+
+            const ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+
+            for (ssize_t offset = 0; offset < length;)
+            {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    onChange({});
+                    continue;
+                }
+
+                std::filesystem::path directory;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    auto watched = directories.find(event->wd);
+
+                    if (watched == directories.end())
+                    {
+                        continue;
+                    }
+                    directory = watched->second;
+
+                    if (event->mask & IN_IGNORED)
+                    {
+                        directories.erase(watched);
+                    }
+                }
+
+                onChange(event->len > 0 ? directory / event->name : directory);
+            }
+        }
+    }
+
+    bool Watch(const std::filesystem::path& directory)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (inotifyFd == -1)
+        {
+            inotifyFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+
+            if (inotifyFd == -1)
+            {
+                LOG_ERROR("failed to initialize inotify -> {}", errno);
+                return false;
+            }
+            thread = std::thread(&Backend::Run, this);
+        }
+
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+        const int watchDescriptor = inotify_add_watch(inotifyFd, directory.c_str(), mask);
+
+        if (watchDescriptor == -1)
+        {
+            return false;
+        }
+
+        // adding the same directory twice hands back the same descriptor.
+        directories[watchDescriptor] = directory;
+        return true;
+    }
+
+    ~Backend()
+    {
+        stopping = true;
+
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+        if (inotifyFd != -1)
+        {
+            close(inotifyFd);
+        }
+    }
+};
+#else
+struct SystemIO::FileWatcher::Backend
+{
+    Callback onChange;
+
+    bool Watch(const std::filesystem::path&)
+    {
+        return false;
+    }
+};
+#endif
+
+SystemIO::FileWatcher::FileWatcher(Callback onChange) : m_backend(std::make_unique<Backend>())
+{
+    m_backend->onChange = std::move(onChange);
+}
+
+SystemIO::FileWatcher::~FileWatcher() = default;
+
+bool SystemIO::FileWatcher::Watch(const std::filesystem::path& directory)
+{
+    return m_backend->Watch(directory);
+}
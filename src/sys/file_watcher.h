@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <functional>
+#include <filesystem>
+
+namespace SystemIO
+{
+    /**
+     * Reports changes to files in a set of directories, using inotify on linux and ReadDirectoryChangesW on windows.
+     * Directories are watched non recursively, and the callback runs on the watcher's own thread.
+     */
+    class FileWatcher
+    {
+    public:
+        /**
+         * @param changedPath the file that changed, the watched directory itself if the os dropped events for it,
+         * or an empty path if it dropped events for every directory.
+         */
+        using Callback = std::function<void(const std::filesystem::path& changedPath)>;
+
+        explicit FileWatcher(Callback onChange);
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        /// @return false if the directory can't be watched, in which case callers have to revalidate on their own.
+        bool Watch(const std::filesystem::path& directory);
+
+    private:
+        struct Backend;
+        std::unique_ptr<Backend> m_backend;
+    };
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <string_view>
+
+/**
+ * 64-bit FNV-1a. Not cryptographic, but unlike std::hash it's 64 bits wide on the 32-bit builds too, which is
+ * what keys over file and document contents need to stay collision free in practice.
+ */
+inline unsigned long long HashContents(std::string_view contents)
+{
+    unsigned long long hash = 14695981039346656037ull;
+
+    for (const unsigned char c : contents)
+    {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
@@ -22,6 +22,7 @@ public:
         std::filesystem::path backendAbsoluteDirectory;
         std::filesystem::path frontendAbsoluteDirectory;
         std::filesystem::path webkitAbsolutePath;
+        std::vector<std::string> webkitPatterns = { ".*" }; // url regexes of the documents webkit.js is injected into
         bool isInternal = false;
     };
 
@@ -0,0 +1,107 @@
+#pragma once
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Bounded map that evicts the least recently used entries. Entries weigh 1 unless Put is given a weight, so the
+ * capacity is either a number of entries or, e.g. for cached bodies, a number of bytes. Not thread-safe, callers lock around it.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache
+{
+public:
+    explicit LruCache(std::size_t capacity) : m_capacity(capacity) {}
+
+    /// @return the cached value, or nullptr. the pointer is invalidated by the next Put.
+    const Value* Get(const Key& key)
+    {
+        auto it = m_index.find(key);
+
+        if (it == m_index.end())
+        {
+            return nullptr;
+        }
+
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return &it->second->value;
+    }
+
+    /// @brief insert or replace an entry. one that weighs more than the whole capacity isn't kept at all.
+    void Put(const Key& key, Value value, std::size_t weight = 1)
+    {
+        this->Remove(key);
+
+        if (weight > m_capacity)
+        {
+            return;
+        }
+
+        while (!m_entries.empty() && m_weight + weight > m_capacity)
+        {
+            m_weight -= m_entries.back().weight;
+            m_index.erase(m_entries.back().key);
+            m_entries.pop_back();
+        }
+
+        m_entries.push_front({ key, std::move(value), weight });
+        m_index.emplace(key, m_entries.begin());
+        m_weight += weight;
+    }
+
+    bool Remove(const Key& key)
+    {
+        auto it = m_index.find(key);
+
+        if (it == m_index.end())
+        {
+            return false;
+        }
+
+        m_weight -= it->second->weight;
+        m_entries.erase(it->second);
+        m_index.erase(it);
+        return true;
+    }
+
+    /// @brief remove every entry whose key matches `predicate`.
+    template <typename Predicate>
+    void RemoveIf(Predicate predicate)
+    {
+        for (auto it = m_entries.begin(); it != m_entries.end();)
+        {
+            if (!predicate(it->key))
+            {
+                ++it;
+                continue;
+            }
+
+            m_weight -= it->weight;
+            m_index.erase(it->key);
+            it = m_entries.erase(it);
+        }
+    }
+
+    void Clear()
+    {
+        m_index.clear();
+        m_entries.clear();
+        m_weight = 0;
+    }
+
+    std::size_t Size() const { return m_entries.size(); }
+    std::size_t Weight() const { return m_weight; }
+
+private:
+    struct Entry
+    {
+        Key key;
+        Value value;
+        std::size_t weight;
+    };
+
+    std::size_t m_capacity;
+    std::size_t m_weight = 0;
+    std::list<Entry> m_entries;
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> m_index;
+};
@@ -1,5 +1,6 @@
 #include "locals.h"
 #include <fstream>
+#include <algorithm>
 #include <sys/log.h>
 #include <fmt/core.h>
 #include <iostream>
@@ -174,6 +175,25 @@ SettingsStore::PluginTypeSchema SettingsStore::GetPluginInternalData(nlohmann::j
     plugin.frontendAbsoluteDirectory = (FileSystem::path)pluginDirName / ".millennium" / "Dist" / "index.js";
     plugin.webkitAbsolutePath        = (FileSystem::path)pluginDirName / ".millennium" / "Dist" / "webkit.js";
 
+    // optional, either one regex or a list of them. without it the webkit module is injected into every document.
+    if (json.contains("webkitPatterns"))
+    {
+        const auto& webkitPatterns = json["webkitPatterns"];
+
+        if (webkitPatterns.is_string())
+        {
+            plugin.webkitPatterns = { webkitPatterns.get<std::string>() };
+        }
+        else if (webkitPatterns.is_array() && !webkitPatterns.empty() && std::all_of(webkitPatterns.begin(), webkitPatterns.end(), [](const nlohmann::json& pattern) { return pattern.is_string(); }))
+        {
+            plugin.webkitPatterns = webkitPatterns.get<std::vector<std::string>>();
+        }
+        else
+        {
+            Logger.Warn("plugin '{}' has an invalid 'webkitPatterns' in '{}', expected a string or a list of strings", pluginDirName, SettingsStore::pluginConfigFile);
+        }
+    }
+
     return plugin;
 }
 